@@ -5,6 +5,34 @@
  * CS 300, Spring 2025 – Interview Booth Project
  *
  * Synchronization is implemented using mutexes and semaphores.
+ *
+ * Several recruiters can interview at once. Each recruiter has its own
+ * waiting queue of numChairs chairs guarded by its own mutex, and each
+ * student waits for the end of an interview on a private semaphore.
+ * Students line up at their own recruiter ((id - 1) % R); a recruiter
+ * whose queue is empty steals the most recently seated student from
+ * another recruiter's queue before working on its own tasks.
+ *
+ * With --virtual the same state machine runs as a discrete-event
+ * simulation on a virtual clock instead of threads: every sleep becomes an
+ * event in a priority queue ordered by virtual time (ties in scheduling
+ * order). Only the final statistics are printed, in virtual seconds.
+ * Every retry of a student who found no free chair is still an event, so
+ * when the recruiters cannot keep up the event count grows roughly with
+ * the square of the students: with 1-5 sec times and one recruiter, 1000
+ * students take about 0.1 sec, 3000 about 1.4 sec and 10000 about 17 sec.
+ * With enough recruiters to seat students as they arrive (e.g. 100000
+ * students and 300 recruiters) it stays well under a second.
+ *
+ * With --tasks the students are not threads but stackless state machines
+ * run by a fixed pool of worker threads, one per core. A student that
+ * studies is parked on a timer heap and one waiting for an interview is
+ * parked until its recruiter wakes it, so neither blocks a worker; tens
+ * of thousands of students need no more threads than the recruiters and
+ * the pool. The 0.1 sec arrival stagger becomes a start time per student.
+ *
+ * Usage: ./booth [--virtual | --tasks] <num_students> <num_chairs> <left_time> <right_time> [num_recruiters]
+ * Build: gcc -O2 -pthread -o booth P3-sem-Jay2.c mytime.c
  */
 
 #include <stdio.h>
@@ -12,24 +40,70 @@
 #include <string.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <ctype.h>
+#include <time.h>
 #include <unistd.h>
 #include "mytime.h"  // Assumes mytime(left, right) is provided
 
+// A recruiter and its waiting room
+typedef struct {
+    int id;                    // Recruiter id (starting from 1)
+    int *chairs;               // Circular queue of waiting student ids
+    int numberStudentsWaiting; // Current count of waiting students
+    int nextSeatingPos;        // Next available seat index (circular)
+    int nextInterviewPos;      // Next chair index from which the recruiter picks a student
+    pthread_mutex_t mutex;     // Guards the chairs
+    int interviews;            // Interviews conducted
+    int stolen;                // Interviews of students stolen from other queues
+    double busySeconds;        // Time spent interviewing
+} Recruiter;
+
 // Global variables shared among threads
-int numChairs;                 // Number of chairs in the waiting room
+int numChairs;                 // Number of chairs in each waiting room
 int numStudents;               // Total number of students
+int numRecruiters = 1;         // Number of recruiters (each with its own queue)
 int leftTime, rightTime;       // Sleep interval boundaries
 
-int *waitingRoomChairs;        // Array representing chairs (0 means empty, otherwise holds student id)
-int numberStudentsWaiting = 0; // Current count of waiting students
-int nextSeatingPos = 0;        // Next available seat index (circular)
-int nextInterviewPos = 0;      // Next chair index from which recruiter picks a student
+Recruiter *recruiters;
+sem_t *semInterviewed;         // semInterviewed[id - 1]: posted when student id's interview is done
+int verbose = 1;               // Print every step (off in virtual time)
+_Atomic uint64_t *nonEmpty;    // Bit i set while recruiter i has students waiting
+
+// Discrete-event simulation: what happens when an event's time comes
+enum { STUDY_DONE, RECRUITER_READY, INTERVIEW_DONE };
+
+typedef struct {
+    double time;               // Virtual time in seconds
+    long seq;                  // Scheduling order, breaks ties
+    int type;
+    int who;                   // Student id, or recruiter index
+    int student;               // Student being interviewed (INTERVIEW_DONE)
+} Event;
+
+Event *events;                 // Binary min-heap on (time, seq)
+int numEvents = 0;
+long nextSeq = 0;
+
+// Worker pool mode: what a student task does the next time it runs
+enum { TASK_STUDY, TASK_ARRIVE, TASK_INTERVIEWED };
 
-// Semaphores and mutex for synchronization
-sem_t semStudents;     // Counts waiting students (student posts when seated)
-sem_t semRecruiter;    // Used to signal a student that his/her interview is done
-pthread_mutex_t mutexThread;
+typedef struct {
+    int id;                    // Student id (starting from 1)
+    int state;
+    int interviewsDone;
+} StudentTask;
+
+int useTasks = 0;              // Students are tasks on the worker pool
+StudentTask *tasks;
+int *readyTasks;               // Circular queue of runnable student ids
+int readyHead = 0, readyCount = 0;
+int tasksFinished = 0;
+int poolDone = 0;              // Tells the workers to exit
+pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;  // Guards the ready queue, timers and counters
+pthread_cond_t poolCond;       // Work became ready or a timer was added
+pthread_cond_t allFinished = PTHREAD_COND_INITIALIZER;  // Every student task is done
 
 // Utility function: checks if the string is a positive number.
 int isNumber(char number[]) {
@@ -40,169 +114,507 @@ int isNumber(char number[]) {
     return 1;
 }
 
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Set or clear a recruiter's bit in nonEmpty (called under its mutex).
+void markWaiting(Recruiter *r, int waiting) {
+    int i = r->id - 1;
+    uint64_t bit = (uint64_t)1 << (i % 64);
+    if (waiting) atomic_fetch_or_explicit(&nonEmpty[i / 64], bit, memory_order_relaxed);
+    else atomic_fetch_and_explicit(&nonEmpty[i / 64], ~bit, memory_order_relaxed);
+}
+
+// Seat a student in a recruiter's waiting room; returns 0 if no chair is free.
+int seatStudent(Recruiter *r, int id) {
+    int seated = 0;
+    pthread_mutex_lock(&r->mutex);
+    if (r->numberStudentsWaiting < numChairs) {
+        r->chairs[r->nextSeatingPos] = id;
+        if (r->numberStudentsWaiting++ == 0) markWaiting(r, 1);
+        r->nextSeatingPos = (r->nextSeatingPos + 1) % numChairs;
+        seated = 1;
+        if (verbose) printf("Student %d takes a seat. Students waiting = %d.\n", id, r->numberStudentsWaiting);
+    }
+    pthread_mutex_unlock(&r->mutex);
+    return seated;
+}
+
+// Take the next student from a recruiter's own queue, or 0 if it is empty.
+int takeOwnStudent(Recruiter *r) {
+    int studentId = 0;
+    pthread_mutex_lock(&r->mutex);
+    if (r->numberStudentsWaiting > 0) {
+        studentId = r->chairs[r->nextInterviewPos];
+        r->chairs[r->nextInterviewPos] = 0; // Remove the student from the chair
+        if (--r->numberStudentsWaiting == 0) markWaiting(r, 0);
+        r->nextInterviewPos = (r->nextInterviewPos + 1) % numChairs;
+        if (verbose) printf("Recruiter %d starts interviewing Student %d. Students waiting = %d.\n",
+                            r->id, studentId, r->numberStudentsWaiting);
+    }
+    pthread_mutex_unlock(&r->mutex);
+    return studentId;
+}
+
+// Steal the most recently seated student from the first other recruiter
+// (in id order after r) with a waiting student, or return 0. The nonEmpty
+// bits let the search skip 64 idle recruiters at a time.
+int stealStudent(Recruiter *r) {
+    for (int k = 1; k < numRecruiters; k++) {
+        int v = (r->id - 1 + k) % numRecruiters;
+        uint64_t bits = atomic_load_explicit(&nonEmpty[v / 64], memory_order_relaxed) >> (v % 64);
+        if (bits == 0) {
+            // Nobody waiting up to the end of this word (or of the recruiters)
+            int step = 64 - v % 64 < numRecruiters - v ? 64 - v % 64 : numRecruiters - v;
+            k += step - 1;
+            continue;
+        }
+        int skip = __builtin_ctzll(bits);
+        if (skip > 0) {
+            k += skip - 1;
+            continue;
+        }
+        Recruiter *victim = &recruiters[v];
+        int studentId = 0;
+        pthread_mutex_lock(&victim->mutex);
+        if (victim->numberStudentsWaiting > 0) {
+            victim->nextSeatingPos = (victim->nextSeatingPos + numChairs - 1) % numChairs;
+            studentId = victim->chairs[victim->nextSeatingPos];
+            victim->chairs[victim->nextSeatingPos] = 0;
+            if (--victim->numberStudentsWaiting == 0) markWaiting(victim, 0);
+            if (verbose) printf("Recruiter %d steals Student %d from Recruiter %d. Students waiting there = %d.\n",
+                                r->id, studentId, victim->id, victim->numberStudentsWaiting);
+        }
+        pthread_mutex_unlock(&victim->mutex);
+        if (studentId != 0) return studentId;
+    }
+    return 0;
+}
+
+// Make a parked student task runnable (call with poolLock held).
+void pushReady(int id) {
+    readyTasks[(readyHead + readyCount) % numStudents] = id;
+    readyCount++;
+    pthread_cond_signal(&poolCond);
+}
+
+// Tell a student that his/her interview is done.
+void finishInterview(int studentId) {
+    if (useTasks) {
+        pthread_mutex_lock(&poolLock);
+        pushReady(studentId);
+        pthread_mutex_unlock(&poolLock);
+    } else {
+        sem_post(&semInterviewed[studentId - 1]);
+    }
+}
+
 // Recruiter thread function.
-// The recruiter continuously checks for waiting students. When there are none,
-// the recruiter “works on his own” (sleeps for a random time). When a student is waiting,
-// the recruiter removes the student from the waiting room and conducts an interview.
+// The recruiter continuously checks its own queue, then the others'. When
+// no student is waiting anywhere, the recruiter “works on his own” (sleeps
+// for a random time). Otherwise the recruiter removes the student from the
+// waiting room and conducts an interview.
 void* recruiter_actions(void* arg) {
-    (void)arg;  // Unused parameter
+    Recruiter *r = arg;
     while (1) {
-        // Lock to check if any student is waiting
-        printf("Recruiter will call mutex_lock on mutexThread.\n");
-        pthread_mutex_lock(&mutexThread);
-        if (numberStudentsWaiting == 0) {
-            printf("Recruiter call mutex_unlock on mutexThread.\n");
-            pthread_mutex_unlock(&mutexThread);
-            printf("Recruiter: No students waiting. Working on own tasks.\n");
+        int studentId = takeOwnStudent(r);
+        if (studentId == 0 && numRecruiters > 1) {
+            studentId = stealStudent(r);
+            if (studentId != 0) r->stolen++;
+        }
+        if (studentId == 0) {
+            printf("Recruiter %d: No students waiting. Working on own tasks.\n", r->id);
             int workTime = mytime(leftTime, rightTime);
-            printf("Recruiter to sleep %d sec; (Working on own tasks)\n", workTime);
+            printf("Recruiter %d to sleep %d sec; (Working on own tasks)\n", r->id, workTime);
             sleep(workTime);
-            printf("Recruiter wake up; (Finished own tasks)\n");
+            printf("Recruiter %d wake up; (Finished own tasks)\n", r->id);
             continue;
         }
-        // At least one student is waiting; prepare to interview.
-        printf("Recruiter call mutex_unlock on mutexThread.\n");
-        pthread_mutex_unlock(&mutexThread);
-        
-        // Wait for a student to signal that they are seated.
-        printf("Recruiter will call sem_wait on semStudents.\n");
-        sem_wait(&semStudents);
-        printf("Recruiter call sem_wait on semStudents; proceeding with interview.\n");
-        
-        // Lock to remove the student from the waiting room
-        printf("Recruiter will call mutex_lock on mutexThread.\n");
-        pthread_mutex_lock(&mutexThread);
-        
-        int studentId = waitingRoomChairs[nextInterviewPos];
-        waitingRoomChairs[nextInterviewPos] = 0; // Remove the student from the chair
-        numberStudentsWaiting--;
-        nextInterviewPos = (nextInterviewPos + 1) % numChairs;
-        
-        printf("Recruiter starts interviewing Student %d. Students waiting = %d.\n", studentId, numberStudentsWaiting);
-        
-        printf("Recruiter call mutex_unlock on mutexThread.\n");
-        pthread_mutex_unlock(&mutexThread);
-        
+
         // Simulate interview time using mytime function
         int interviewTime = mytime(leftTime, rightTime);
-        printf("Recruiter to sleep %d sec; (Interviewing Student %d)\n", interviewTime, studentId);
+        printf("Recruiter %d to sleep %d sec; (Interviewing Student %d)\n", r->id, interviewTime, studentId);
+        double start = now();
         sleep(interviewTime);
-        printf("Recruiter wake up; (Finished interviewing Student %d)\n", studentId);
-        
+        r->busySeconds += now() - start;
+        r->interviews++;
+        printf("Recruiter %d wake up; (Finished interviewing Student %d)\n", r->id, studentId);
+
         // Signal the interviewed student that his/her interview is done.
-        printf("Recruiter will call sem_post on semRecruiter for Student %d.\n", studentId);
-        sem_post(&semRecruiter);
-        printf("Recruiter call sem_post on semRecruiter for Student %d.\n", studentId);
+        printf("Recruiter %d signals Student %d.\n", r->id, studentId);
+        finishInterview(studentId);
     }
-    printf("Recruiter %lu leaves\n", (unsigned long)pthread_self());
     return NULL;
 }
 
 // Student thread function.
 // Each student alternates between studying and attempting to get an interview.
-// If a chair is available in the waiting room, the student takes a seat and signals the recruiter.
-// Then, the student waits until the recruiter completes the interview. After two interviews,
-// the student terminates.
+// If a chair is available in the waiting room of the student's recruiter, the
+// student takes a seat. Then, the student waits until some recruiter completes
+// the interview. After two interviews, the student terminates.
 void* student_actions(void* arg) {
     int id = *(int*)arg;  // Student id (starting from 1)
+    Recruiter *r = &recruiters[(id - 1) % numRecruiters];
     int interviewsDone = 0;
-    
+
     while (interviewsDone < 2) {
         // Student is studying (programming) before attempting an interview.
         int studyTime = mytime(leftTime, rightTime);
         printf("Student %d to sleep %d sec; (Studying)\n", id, studyTime);
         sleep(studyTime);
         printf("Student %d wake up; (Finished studying)\n", id);
-        
-        // Student arrives at the booth.
-        printf("Student %d arrives and will call mutex_lock on mutexThread.\n", id);
-        pthread_mutex_lock(&mutexThread);
-        
-        // Check if there is an available chair.
-        if (numberStudentsWaiting < numChairs) {
-            // Take a seat.
-            waitingRoomChairs[nextSeatingPos] = id;
-            numberStudentsWaiting++;
-            printf("Student %d takes a seat. Students waiting = %d.\n", id, numberStudentsWaiting);
-            nextSeatingPos = (nextSeatingPos + 1) % numChairs;
-            printf("Student %d call mutex_unlock on mutexThread.\n", id);
-            pthread_mutex_unlock(&mutexThread);
-            
-            // Signal the recruiter that a student is waiting.
-            printf("Student %d will call sem_post on semStudents.\n", id);
-            sem_post(&semStudents);
-            printf("Student %d call sem_post on semStudents.\n", id);
-            
-            // Wait until the recruiter completes the interview.
-            printf("Student %d will call sem_wait on semRecruiter.\n", id);
-            sem_wait(&semRecruiter);
-            printf("Student %d call sem_wait on semRecruiter and has been interviewed.\n", id);
-            
+
+        // Student arrives at the booth and takes a seat if one is available.
+        printf("Student %d arrives at Recruiter %d.\n", id, r->id);
+        if (seatStudent(r, id)) {
+            // Wait until a recruiter completes the interview.
+            printf("Student %d will call sem_wait on semInterviewed.\n", id);
+            sem_wait(&semInterviewed[id - 1]);
+
             interviewsDone++;
             printf("Student %d has completed interview %d.\n", id, interviewsDone);
         } else {
             // No chair available; leave and try later.
             printf("Student %d finds no available chairs and will try later.\n", id);
-            printf("Student %d call mutex_unlock on mutexThread.\n", id);
-            pthread_mutex_unlock(&mutexThread);
         }
     }
     printf("Student %d has completed two interviews and will terminate.\n", id);
     return NULL;
 }
 
+// Add an event to the heap.
+void schedule(double time, int type, int who, int student) {
+    int i = numEvents++;
+    Event e = {time, nextSeq++, type, who, student};
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        Event *p = &events[parent];
+        if (p->time < e.time || (p->time == e.time && p->seq < e.seq)) break;
+        events[i] = *p;
+        i = parent;
+    }
+    events[i] = e;
+}
+
+// Remove and return the earliest event.
+Event nextEvent() {
+    Event first = events[0];
+    Event last = events[--numEvents];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= numEvents) break;
+        if (child + 1 < numEvents && (events[child + 1].time < events[child].time ||
+            (events[child + 1].time == events[child].time && events[child + 1].seq < events[child].seq)))
+            child++;
+        if (last.time < events[child].time || (last.time == events[child].time && last.seq < events[child].seq))
+            break;
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+    return first;
+}
+
+// Recruiter r looks for a student at virtual time t, exactly as one pass of
+// recruiter_actions: interview (own queue first, then steal) or own tasks.
+void recruiterReady(Recruiter *r, double t) {
+    int studentId = takeOwnStudent(r);
+    if (studentId == 0 && numRecruiters > 1) {
+        studentId = stealStudent(r);
+        if (studentId != 0) r->stolen++;
+    }
+    if (studentId == 0) {
+        schedule(t + mytime(leftTime, rightTime), RECRUITER_READY, r->id - 1, 0);
+        return;
+    }
+    int interviewTime = mytime(leftTime, rightTime);
+    r->busySeconds += interviewTime;
+    schedule(t + interviewTime, INTERVIEW_DONE, r->id - 1, studentId);
+}
+
+// Run the whole simulation on a virtual clock; returns the virtual time at
+// which the last student finished.
+double runVirtual() {
+    int *interviewsDone = calloc(numStudents, sizeof(int));
+    events = malloc((numStudents + numRecruiters) * sizeof(Event));
+    if (interviewsDone == NULL || events == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    // Recruiters start at once; students start studying 0.1 sec apart
+    for (int i = 0; i < numRecruiters; i++) {
+        schedule(0, RECRUITER_READY, i, 0);
+    }
+    for (int i = 0; i < numStudents; i++) {
+        schedule(0.1 * i + mytime(leftTime, rightTime), STUDY_DONE, i + 1, 0);
+    }
+
+    double t = 0;
+    int finished = 0;
+    while (finished < numStudents) {
+        Event e = nextEvent();
+        t = e.time;
+        if (e.type == STUDY_DONE) {
+            // Seated students wait for an interview; others study again
+            if (!seatStudent(&recruiters[(e.who - 1) % numRecruiters], e.who)) {
+                schedule(t + mytime(leftTime, rightTime), STUDY_DONE, e.who, 0);
+            }
+        } else if (e.type == RECRUITER_READY) {
+            recruiterReady(&recruiters[e.who], t);
+        } else {
+            Recruiter *r = &recruiters[e.who];
+            r->interviews++;
+            if (++interviewsDone[e.student - 1] == 2) {
+                finished++;
+            } else {
+                schedule(t + mytime(leftTime, rightTime), STUDY_DONE, e.student, 0);
+            }
+            recruiterReady(r, t);
+        }
+    }
+
+    free(interviewsDone);
+    free(events);
+    return t;
+}
+
+// Park a student task until `seconds` from now (call with poolLock held).
+void sleepTask(StudentTask *s, double seconds) {
+    schedule(now() + seconds, STUDY_DONE, s->id, 0);
+    pthread_cond_signal(&poolCond);
+}
+
+// Run a student task until it blocks: the same steps as student_actions,
+// with each sleep or sem_wait turned into parking the task.
+void runStudent(StudentTask *s) {
+    Recruiter *r = &recruiters[(s->id - 1) % numRecruiters];
+    for (;;) {
+        if (s->state == TASK_STUDY) {
+            // Student is studying (programming) before attempting an interview.
+            int studyTime = mytime(leftTime, rightTime);
+            printf("Student %d to sleep %d sec; (Studying)\n", s->id, studyTime);
+            s->state = TASK_ARRIVE;
+            pthread_mutex_lock(&poolLock);
+            sleepTask(s, studyTime);
+            pthread_mutex_unlock(&poolLock);
+            return;
+        } else if (s->state == TASK_ARRIVE) {
+            printf("Student %d wake up; (Finished studying)\n", s->id);
+            printf("Student %d arrives at Recruiter %d.\n", s->id, r->id);
+            // Once seated the task belongs to the recruiter that interviews it
+            int id = s->id;
+            s->state = TASK_INTERVIEWED;
+            if (seatStudent(r, id)) {
+                printf("Student %d waits for the interview.\n", id);
+                return;
+            }
+            printf("Student %d finds no available chairs and will try later.\n", id);
+            s->state = TASK_STUDY;
+        } else {
+            s->interviewsDone++;
+            printf("Student %d has completed interview %d.\n", s->id, s->interviewsDone);
+            if (s->interviewsDone < 2) {
+                s->state = TASK_STUDY;
+                continue;
+            }
+            printf("Student %d has completed two interviews and will terminate.\n", s->id);
+            pthread_mutex_lock(&poolLock);
+            if (++tasksFinished == numStudents) pthread_cond_signal(&allFinished);
+            pthread_mutex_unlock(&poolLock);
+            return;
+        }
+    }
+}
+
+// Worker thread function: run ready student tasks, moving tasks whose
+// timers are due to the ready queue, and wait for the next timer when idle.
+void* worker_actions(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&poolLock);
+    while (!poolDone) {
+        double t = now();
+        while (numEvents > 0 && events[0].time <= t) {
+            pushReady(nextEvent().who);
+        }
+        if (readyCount > 0) {
+            int id = readyTasks[readyHead];
+            readyHead = (readyHead + 1) % numStudents;
+            readyCount--;
+            pthread_mutex_unlock(&poolLock);
+            runStudent(&tasks[id - 1]);
+            pthread_mutex_lock(&poolLock);
+        } else if (numEvents > 0) {
+            double wake = events[0].time;
+            struct timespec ts = {(time_t)wake, (long)((wake - (time_t)wake) * 1e9)};
+            pthread_cond_timedwait(&poolCond, &poolLock, &ts);
+        } else {
+            pthread_cond_wait(&poolCond, &poolLock);
+        }
+    }
+    pthread_mutex_unlock(&poolLock);
+    return NULL;
+}
+
+// Run the students as tasks on a pool of one worker per core; returns when
+// every student has had two interviews.
+void runTasks(double start) {
+    long numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numWorkers < 1) numWorkers = 1;
+    tasks = malloc(numStudents * sizeof(StudentTask));
+    readyTasks = malloc(numStudents * sizeof(int));
+    events = malloc(numStudents * sizeof(Event));
+    pthread_t *workers = malloc(numWorkers * sizeof(pthread_t));
+    if (tasks == NULL || readyTasks == NULL || events == NULL || workers == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    // Timers use the same clock as now()
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&poolCond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    // Students start 0.1 sec apart, as with one thread each
+    for (int i = 0; i < numStudents; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].state = TASK_STUDY;
+        tasks[i].interviewsDone = 0;
+        schedule(start + 0.1 * i, STUDY_DONE, i + 1, 0);
+    }
+
+    printf("Running %d students as tasks on %ld worker threads.\n", numStudents, numWorkers);
+    for (long i = 0; i < numWorkers; i++) {
+        if (pthread_create(&workers[i], NULL, worker_actions, NULL) != 0) {
+            perror("pthread_create worker");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Wait for every student, then stop the workers
+    pthread_mutex_lock(&poolLock);
+    while (tasksFinished < numStudents) {
+        pthread_cond_wait(&allFinished, &poolLock);
+    }
+    poolDone = 1;
+    pthread_cond_broadcast(&poolCond);
+    pthread_mutex_unlock(&poolLock);
+    for (long i = 0; i < numWorkers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&poolCond);
+    free(tasks);
+    free(readyTasks);
+    free(events);
+    free(workers);
+}
+
 int main(int argc, char **argv) {
-    // Expect exactly 4 command-line arguments:
-    // <num_students> <num_chairs> <left_time> <right_time>
-    if (argc != 5) {
-        printf("Usage: %s <num_students> <num_chairs> <left_time> <right_time>\n", argv[0]);
+    // Take out the --virtual and --tasks flags
+    int virtualTime = 0;
+    int numArgs = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--virtual") == 0) virtualTime = 1;
+        else if (strcmp(argv[i], "--tasks") == 0) useTasks = 1;
+        else argv[numArgs++] = argv[i];
+    }
+    argc = numArgs;
+
+    // Expect 4 command-line arguments and an optional recruiter count:
+    // <num_students> <num_chairs> <left_time> <right_time> [num_recruiters]
+    if ((argc != 5 && argc != 6) || (virtualTime && useTasks)) {
+        printf("Usage: %s [--virtual | --tasks] <num_students> <num_chairs> <left_time> <right_time> [num_recruiters]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
-    
+
     // Validate inputs
-    if (!isNumber(argv[1]) || !isNumber(argv[2]) || !isNumber(argv[3]) || !isNumber(argv[4])) {
-        printf("Invalid input. All inputs must be positive integers.\n");
-        exit(EXIT_FAILURE);
+    for (int i = 1; i < argc; i++) {
+        if (!isNumber(argv[i])) {
+            printf("Invalid input. All inputs must be positive integers.\n");
+            exit(EXIT_FAILURE);
+        }
     }
-    
+
     numStudents = atoi(argv[1]);
     numChairs = atoi(argv[2]);
     leftTime = atoi(argv[3]);
     rightTime = atoi(argv[4]);
-    
-    // Allocate waiting room chairs array and initialize to 0 (empty)
-    waitingRoomChairs = malloc(numChairs * sizeof(int));
-    if (waitingRoomChairs == NULL) {
+    if (argc == 6) numRecruiters = atoi(argv[5]);
+    if (numStudents < 1 || numChairs < 1 || numRecruiters < 1 || rightTime <= leftTime) {
+        printf("Invalid input. Students, chairs and recruiters must be at least 1 and left_time below right_time.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Set up the recruiters, each with its chairs initialized to 0 (empty)
+    recruiters = calloc(numRecruiters, sizeof(Recruiter));
+    nonEmpty = calloc((numRecruiters + 63) / 64, sizeof(*nonEmpty));
+    semInterviewed = malloc(numStudents * sizeof(sem_t));
+    if (recruiters == NULL || nonEmpty == NULL || semInterviewed == NULL) {
         perror("malloc");
         exit(EXIT_FAILURE);
     }
-    for (int i = 0; i < numChairs; i++) {
-        waitingRoomChairs[i] = 0;
+    for (int i = 0; i < numRecruiters; i++) {
+        recruiters[i].id = i + 1;
+        recruiters[i].chairs = calloc(numChairs, sizeof(int));
+        if (recruiters[i].chairs == NULL) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        pthread_mutex_init(&recruiters[i].mutex, NULL);
     }
-    
-    // Initialize semaphores and mutex
-    sem_init(&semStudents, 0, 0);
-    sem_init(&semRecruiter, 0, 0);
-    pthread_mutex_init(&mutexThread, NULL);
-    
+    for (int i = 0; i < numStudents; i++) {
+        sem_init(&semInterviewed[i], 0, 0);
+    }
+
     // Seed the random number generator (for mytime function)
     srand(time(NULL));
-    
-    // Create the recruiter thread.
-    pthread_t recruiter;
-    if (pthread_create(&recruiter, NULL, recruiter_actions, NULL) != 0) {
-        perror("pthread_create recruiter");
+    double start = now();
+    double elapsed;
+    pthread_t *recruiterThreads = NULL;
+    pthread_t *students = NULL;
+    int *studentIds = NULL;
+
+    if (virtualTime) {
+        verbose = 0;
+        elapsed = runVirtual();
+        printf("Virtual time simulation took %.3f sec of real time.\n", now() - start);
+        goto report;
+    }
+
+    // Create the recruiter threads.
+    recruiterThreads = malloc(numRecruiters * sizeof(pthread_t));
+    if (recruiterThreads == NULL) {
+        perror("malloc");
         exit(EXIT_FAILURE);
     }
-    
+    for (int i = 0; i < numRecruiters; i++) {
+        if (pthread_create(&recruiterThreads[i], NULL, recruiter_actions, &recruiters[i]) != 0) {
+            perror("pthread_create recruiter");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (useTasks) {
+        runTasks(start);
+        elapsed = now() - start;
+        goto cancel;
+    }
+
     // Create student threads.
-    pthread_t *students = malloc(numStudents * sizeof(pthread_t));
-    int *studentIds = malloc(numStudents * sizeof(int));
+    students = malloc(numStudents * sizeof(pthread_t));
+    studentIds = malloc(numStudents * sizeof(int));
     if (students == NULL || studentIds == NULL) {
         perror("malloc");
         exit(EXIT_FAILURE);
     }
-    
+
     for (int i = 0; i < numStudents; i++) {
         studentIds[i] = i + 1;  // Student id starts from 1
         if (pthread_create(&students[i], NULL, student_actions, (void*)&studentIds[i]) != 0) {
@@ -212,24 +624,49 @@ int main(int argc, char **argv) {
         // Optional short sleep to stagger student arrivals.
         usleep(100000);  // 0.1 sec
     }
-    
+
     // Join all student threads (each student terminates after two interviews)
     for (int i = 0; i < numStudents; i++) {
         pthread_join(students[i], NULL);
     }
-    
-    // After all student threads have terminated, cancel the recruiter thread.
-    pthread_cancel(recruiter);
-    pthread_join(recruiter, NULL);
-    
+    elapsed = now() - start;
+
+    // After all student threads have terminated, cancel the recruiter threads.
+cancel:
+    for (int i = 0; i < numRecruiters; i++) {
+        pthread_cancel(recruiterThreads[i]);
+        pthread_join(recruiterThreads[i], NULL);
+    }
+
+    // Report throughput and how busy each recruiter was.
+report:;
+    long totalInterviews = 0;
+    for (int i = 0; i < numRecruiters; i++) {
+        totalInterviews += recruiters[i].interviews;
+    }
+    printf("\n%d recruiters, %ld interviews in %.1f sec: %.3f interviews/sec\n",
+           numRecruiters, totalInterviews, elapsed, elapsed > 0 ? totalInterviews / elapsed : 0.0);
+    for (int i = 0; i < numRecruiters; i++) {
+        Recruiter *r = &recruiters[i];
+        printf("Recruiter %d: %d interviews (%d stolen), utilization %.1f%%\n",
+               r->id, r->interviews, r->stolen, elapsed > 0 ? 100.0 * r->busySeconds / elapsed : 0.0);
+    }
+
     // Clean up resources.
-    free(waitingRoomChairs);
+    for (int i = 0; i < numRecruiters; i++) {
+        free(recruiters[i].chairs);
+        pthread_mutex_destroy(&recruiters[i].mutex);
+    }
+    for (int i = 0; i < numStudents; i++) {
+        sem_destroy(&semInterviewed[i]);
+    }
+    free(recruiters);
+    free((void *)nonEmpty);
+    free(semInterviewed);
+    free(recruiterThreads);
     free(students);
     free(studentIds);
-    pthread_mutex_destroy(&mutexThread);
-    sem_destroy(&semStudents);
-    sem_destroy(&semRecruiter);
-    
+
     printf("All interviews completed. Program terminating.\n");
     return 0;
 }
@@ -1,96 +1,476 @@
+/*
+ * PC-inputs-main-mytime.c
+ * Full Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Bounded-buffer producer/consumer. Producers put() integers into `buffer`
+ * and consumers get() them back out until they read an end marker. Two
+ * queue implementations share the same buffer:
+ *   - mutex:    one mutex and two condition variables (the baseline)
+ *   - lockfree: a Vyukov-style multi-producer/multi-consumer ring, where
+ *               each slot carries a sequence number and the head and tail
+ *               counters sit on their own cache lines
+ *
+ * put_many() and get_many() move a whole batch per synchronization step:
+ * one lock (or one CAS on the ring's tail or head) covers as many items as
+ * fit, and get_many() drains everything available up to its limit.
+ *
+ * Usage: ./pc [--lockfree] [--producers P] [--batch B] <buffersize> <loops> <consumers>
+ *        ./pc --bench <buffersize> <loops>
+ * Build: gcc -O2 -I. -pthread -o pc PC-inputs-main-mytime.c mytime.c
+ *
+ * The lock-free ring rounds a buffersize of 1 up to 2 slots.
+ *
+ * Each producer puts <loops> items, B at a time with --batch. --bench
+ * moves <loops> items through both queues for several producer and
+ * consumer counts and prints the throughput in operations (one put plus
+ * one get) per second, then the cost per item for growing batch sizes.
+ */
+
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sched.h>
+#include <time.h>
 #include <unistd.h>
 #include <mytime.h>
 
+#define CACHE_LINE 64
+#define END_MARKER -1          // Put once per consumer after the producers finish
+
 int max;
 int loops;
 int consumers = 1;
+int producers = 1;
+int lockfree = 0;              // Use the lock-free ring instead of the mutex queue
+int batch = 1;                 // Items per put_many/get_many call (1 = put/get)
+
+int *buffer;
+
+// Mutex + condition variable queue state
+pthread_mutex_t lock1 = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  notFull = PTHREAD_COND_INITIALIZER;   // Signalled after a get
+pthread_cond_t  notEmpty = PTHREAD_COND_INITIALIZER;  // Signalled after a put
+int fillPos = 0;               // Next slot to put into
+int usePos = 0;                // Next slot to get from
+int count = 0;                 // Items in the buffer
+
+// Lock-free ring state: slot i is free for the put at position p when its
+// sequence is p, and holds that item for the get at position p when it is p + 1.
+// With one slot those two states would look alike, so the ring has at least 2.
+int ringSize;
+_Atomic size_t *sequence;
+struct {
+    _Alignas(CACHE_LINE) _Atomic size_t tail;   // Next position to put
+    _Alignas(CACHE_LINE) _Atomic size_t head;   // Next position to get
+} ring;
+
+// Per-thread results
+long long *consumedSum;        // Sum of the items each consumer got
+long *consumedCount;
+
+void queue_reset() {
+    fillPos = usePos = count = 0;
+    for (int i = 0; i < ringSize; i++) {
+        buffer[i] = 0;
+        atomic_store_explicit(&sequence[i], (size_t)i, memory_order_relaxed);
+    }
+    atomic_store(&ring.tail, 0);
+    atomic_store(&ring.head, 0);
+}
 
-int *buffer;  
- 
-// +++++ pthread APIs: +++++ 
-// pthread_mutex_t  lock1 = PTHREAD_MUTEX_INITIALIZER; 
-// pthread_cond_t   cond1 = PTHREAD_COND_INITIALIZER; 
-// pthread_cond_wait(&cond1, &lock1); 
-// pthread_cond_signal(&cond1); 
-// pthread_mutex_lock(&locl1); 
-// pthread_mutex_unlock(&lock1); 
+void mutex_put(int c) {
+    pthread_mutex_lock(&lock1);
+    while (count == max) {
+        pthread_cond_wait(&notFull, &lock1);
+    }
+    buffer[fillPos] = c;
+    fillPos = (fillPos + 1) % max;
+    count++;
+    pthread_cond_signal(&notEmpty);
+    pthread_mutex_unlock(&lock1);
+}
+
+int mutex_get() {
+    pthread_mutex_lock(&lock1);
+    while (count == 0) {
+        pthread_cond_wait(&notEmpty, &lock1);
+    }
+    int c = buffer[usePos];
+    usePos = (usePos + 1) % max;
+    count--;
+    pthread_cond_signal(&notFull);
+    pthread_mutex_unlock(&lock1);
+    return c;
+}
+
+void ring_put(int c) {
+    size_t pos = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+    for (;;) {
+        size_t seq = atomic_load_explicit(&sequence[pos % ringSize], memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            // Slot is free: claim the position
+            if (atomic_compare_exchange_weak_explicit(&ring.tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else {
+            // Full (diff < 0) or another producer got there first
+            if (diff < 0) sched_yield();
+            pos = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+        }
+    }
+    buffer[pos % ringSize] = c;
+    atomic_store_explicit(&sequence[pos % ringSize], pos + 1, memory_order_release);
+}
+
+int ring_get() {
+    size_t pos = atomic_load_explicit(&ring.head, memory_order_relaxed);
+    for (;;) {
+        size_t seq = atomic_load_explicit(&sequence[pos % ringSize], memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            // Slot holds the item for this position: claim it
+            if (atomic_compare_exchange_weak_explicit(&ring.head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else {
+            // Empty (diff < 0) or another consumer got there first
+            if (diff < 0) sched_yield();
+            pos = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        }
+    }
+    int c = buffer[pos % ringSize];
+    // Free the slot for the put one lap later
+    atomic_store_explicit(&sequence[pos % ringSize], pos + ringSize, memory_order_release);
+    return c;
+}
+
+// Put all n items, as many per lock as there is room for
+void mutex_put_many(const int *items, int n) {
+    pthread_mutex_lock(&lock1);
+    while (n > 0) {
+        while (count == max) {
+            pthread_cond_wait(&notFull, &lock1);
+        }
+        int k = max - count < n ? max - count : n;
+        for (int j = 0; j < k; j++) {
+            buffer[fillPos] = items[j];
+            fillPos = fillPos + 1 == max ? 0 : fillPos + 1;
+        }
+        count += k;
+        items += k;
+        n -= k;
+        pthread_cond_broadcast(&notEmpty);
+    }
+    pthread_mutex_unlock(&lock1);
+}
+
+// Wait for at least one item, then take everything available up to limit
+int mutex_get_many(int *items, int limit) {
+    pthread_mutex_lock(&lock1);
+    while (count == 0) {
+        pthread_cond_wait(&notEmpty, &lock1);
+    }
+    int k = count < limit ? count : limit;
+    for (int j = 0; j < k; j++) {
+        items[j] = buffer[usePos];
+        usePos = usePos + 1 == max ? 0 : usePos + 1;
+    }
+    count -= k;
+    pthread_cond_broadcast(&notFull);
+    pthread_mutex_unlock(&lock1);
+    return k;
+}
+
+// Claim the free slots after tail (up to n) with one CAS and fill them
+void ring_put_many(const int *items, int n) {
+    while (n > 0) {
+        size_t pos = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+        int k = 0;
+        while (k < n && atomic_load_explicit(&sequence[(pos + k) % ringSize], memory_order_acquire) == pos + k) {
+            k++;
+        }
+        if (k == 0) {
+            // Full, or another producer moved tail
+            if ((intptr_t)(atomic_load_explicit(&sequence[pos % ringSize], memory_order_relaxed) - pos) < 0)
+                sched_yield();
+            continue;
+        }
+        if (!atomic_compare_exchange_weak_explicit(&ring.tail, &pos, pos + k,
+                                                   memory_order_relaxed, memory_order_relaxed))
+            continue;
+        for (int j = 0; j < k; j++) {
+            buffer[(pos + j) % ringSize] = items[j];
+            atomic_store_explicit(&sequence[(pos + j) % ringSize], pos + j + 1, memory_order_release);
+        }
+        items += k;
+        n -= k;
+    }
+}
+
+// Claim the filled slots after head (up to limit, at least one) with one CAS
+int ring_get_many(int *items, int limit) {
+    for (;;) {
+        size_t pos = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        int k = 0;
+        while (k < limit && atomic_load_explicit(&sequence[(pos + k) % ringSize], memory_order_acquire) == pos + k + 1) {
+            k++;
+        }
+        if (k == 0) {
+            // Empty, or another consumer moved head
+            if ((intptr_t)(atomic_load_explicit(&sequence[pos % ringSize], memory_order_relaxed) - (pos + 1)) < 0)
+                sched_yield();
+            continue;
+        }
+        if (!atomic_compare_exchange_weak_explicit(&ring.head, &pos, pos + k,
+                                                   memory_order_relaxed, memory_order_relaxed))
+            continue;
+        for (int j = 0; j < k; j++) {
+            items[j] = buffer[(pos + j) % ringSize];
+            atomic_store_explicit(&sequence[(pos + j) % ringSize], pos + j + ringSize, memory_order_release);
+        }
+        return k;
+    }
+}
 
-int get() { 
- 
-} 
+int get() {
+    return lockfree ? ring_get() : mutex_get();
+}
 
-void put (int c) { 	
- 
-} 
+void put (int c) {
+    if (lockfree) ring_put(c);
+    else mutex_put(c);
+}
 
-/*int mysleep (int left, int right)
-{
-	int mytime = 0;
-	int n = 0;
+// Put n items in as few synchronization steps as the free space allows
+void put_many(const int *items, int n) {
+    if (lockfree) ring_put_many(items, n);
+    else mutex_put_many(items, n);
+}
 
-	n = rand()%(right - left);	
-	mytime = left + n;	
-	printf("random time is %d sec\n", mytime);
-	return  mytime;
+// Get between 1 and limit items (all that are available, up to limit)
+int get_many(int *items, int limit) {
+    return lockfree ? ring_get_many(items, limit) : mutex_get_many(items, limit);
 }
-*/
 
 void *producer(void *arg) {
-    int i = (long long int) arg;
-	int t = mytime (0, 5);
-	printf("Pid %d to sleep %d sec\n", i, t);
-	sleep(t);
-    printf("Pid %d wakeup\n", i);
+    (void)arg;
+    if (batch == 1) {
+        for (int i = 0; i < loops; i++) {
+            put(i);
+        }
+        return NULL;
+    }
+    int *items = malloc(batch * sizeof(int));
+    if (items == NULL) {
+        printf("Allocation error!\n");
+        exit(1);
+    }
+    for (int i = 0; i < loops; i += batch) {
+        int n = loops - i < batch ? loops - i : batch;
+        for (int j = 0; j < n; j++) {
+            items[j] = i + j;
+        }
+        put_many(items, n);
+    }
+    free(items);
 	return NULL;
 }
 
 void *consumer(void *arg) {
     int i = (long long int) arg;
-	int t = mytime (5, 15);
-    printf("Cid %d to sleep %d sec\n", i, t);	
-	sleep(t);
-    printf("Cid %d wakeup\n", i);
+    long long sum = 0;
+    long n = 0;
+    if (batch == 1) {
+        for (;;) {
+            int c = get();
+            if (c == END_MARKER) break;
+            sum += c;
+            n++;
+        }
+    } else {
+        int *items = malloc(batch * sizeof(int));
+        if (items == NULL) {
+            printf("Allocation error!\n");
+            exit(1);
+        }
+        int markers = 0;
+        while (markers == 0) {
+            int k = get_many(items, batch);
+            for (int j = 0; j < k; j++) {
+                if (items[j] == END_MARKER) markers++;
+                else { sum += items[j]; n++; }
+            }
+        }
+        // Hand back the end markers meant for other consumers
+        for (; markers > 1; markers--) {
+            put(END_MARKER);
+        }
+        free(items);
+    }
+    consumedSum[i] = sum;
+    consumedCount[i] = n;
 	return NULL;
 }
 
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Run the producers and consumers once; returns the elapsed seconds, or -1
+// if the items got back out do not match the ones put in
+double run() {
+    pthread_t pid[producers];
+    pthread_t cid[consumers];
+    int i;
+
+    queue_reset();
+    double start = now();
+    for (i = 0; i < consumers; i++) {
+		pthread_create(&cid[i], NULL, consumer, (void *) (long long int) i);
+    }
+    for (i = 0; i < producers; i++) {
+        pthread_create(&pid[i], NULL, producer, (void *) (long long int) i);
+    }
+    for (i = 0; i < producers; i++) {
+        pthread_join(pid[i], NULL);
+    }
+    for (i = 0; i < consumers; i++) {
+        put(END_MARKER);
+    }
+    for (i = 0; i < consumers; i++) {
+		pthread_join(cid[i], NULL);
+    }
+    double elapsed = now() - start;
+
+    long long sum = 0;
+    long n = 0;
+    for (i = 0; i < consumers; i++) {
+        sum += consumedSum[i];
+        n += consumedCount[i];
+    }
+    if (n != (long)producers * loops || sum != (long long)producers * loops * (loops - 1LL) / 2) {
+        return -1;
+    }
+    return elapsed;
+}
+
+// Throughput of both queues over a grid of producer and consumer counts,
+// moving `total` items per run
+int bench(int total) {
+    int counts[] = {1, 2, 4, 8};
+    int n = sizeof(counts) / sizeof(counts[0]);
+    printf("queue,producers,consumers,items,seconds,ops_per_sec\n");
+    for (lockfree = 0; lockfree <= 1; lockfree++) {
+        for (int p = 0; p < n; p++) {
+            for (int c = 0; c < n; c++) {
+                producers = counts[p];
+                consumers = counts[c];
+                loops = total / producers;
+                double seconds = run();
+                if (seconds < 0) {
+                    fprintf(stderr, "%s queue lost items with %d producers and %d consumers\n",
+                            lockfree ? "lockfree" : "mutex", producers, consumers);
+                    return 1;
+                }
+                printf("%s,%d,%d,%ld,%.4f,%.0f\n", lockfree ? "lockfree" : "mutex", producers,
+                       consumers, (long)producers * loops, seconds, producers * (double)loops / seconds);
+            }
+        }
+    }
+
+    // Amortized cost per item as the batch grows (2 producers, 2 consumers)
+    printf("\nqueue,batch,items,seconds,ns_per_item\n");
+    producers = consumers = 2;
+    loops = total / producers;
+    for (lockfree = 0; lockfree <= 1; lockfree++) {
+        for (batch = 1; batch <= 256 && batch <= max; batch *= 2) {
+            double seconds = run();
+            if (seconds < 0) {
+                fprintf(stderr, "%s queue lost items with batches of %d\n",
+                        lockfree ? "lockfree" : "mutex", batch);
+                return 1;
+            }
+            printf("%s,%d,%ld,%.4f,%.1f\n", lockfree ? "lockfree" : "mutex", batch,
+                   (long)producers * loops, seconds, seconds * 1e9 / ((double)producers * loops));
+        }
+    }
+    return 0;
+}
 
  int main(int argc, char *argv[]) {
-    if (argc != 4) {
-		fprintf(stderr, "usage: %s <buffersize> <loops> <consumers>\n", argv[0]);
+    char *args[3];
+    int numArgs = 0;
+    int benchMode = 0;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--lockfree") == 0) {
+            lockfree = 1;
+        } else if (strcmp(argv[a], "--bench") == 0) {
+            benchMode = 1;
+        } else if (strcmp(argv[a], "--producers") == 0 && a + 1 < argc) {
+            producers = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--batch") == 0 && a + 1 < argc) {
+            batch = atoi(argv[++a]);
+        } else if (numArgs < 3 && argv[a][0] != '-') {
+            args[numArgs++] = argv[a];
+        } else {
+            numArgs = -1;
+            break;
+        }
+    }
+    if (numArgs != (benchMode ? 2 : 3)) {
+		fprintf(stderr, "usage: %s [--lockfree] [--producers P] [--batch B] <buffersize> <loops> <consumers>\n"
+                        "       %s --bench <buffersize> <loops>\n", argv[0], argv[0]);
 		exit(1);
     }
-	max = atoi(argv[1]);
-    loops = atoi(argv[2]);
-    consumers = atoi(argv[3]);
-	
-    buffer = (int *) malloc(max * sizeof(int));
-    if (buffer == NULL) {printf("Allocation error!\n"); return 0;};
-   
-    int i;
-    for (i = 0; i < max; i++) {
-		buffer[i] = 0;
-	}
-	
-   pthread_t cid[consumers];
-   pthread_t p1;
-   
-   // semaphore init... 
-
-   //srand (time (NULL));   
-	
-   printf("main: begin\n");
-   pthread_create(&p1, NULL, producer, &loops); 
-   for (i = 0; i < consumers; i++) {
-		pthread_create(&cid[i], NULL, consumer, (void *) (long long int) i); 
-   }
-	
-   pthread_join(p1, NULL);
-   for (i = 0; i < consumers; i++) {
-		pthread_join(cid[i], NULL); 
-   }
-   printf("main: end\n");
-   return 0;
+	max = atoi(args[0]);
+    loops = atoi(args[1]);
+    if (!benchMode) consumers = atoi(args[2]);
+    if (max <= 0 || loops < 0 || consumers <= 0 || producers <= 0 || batch <= 0) {
+        fprintf(stderr, "buffersize, consumers, producers and batch must be positive\n");
+        exit(1);
+    }
+
+    // Room for the largest consumer count the benchmark uses
+    int slots = consumers > 8 ? consumers : 8;
+    ringSize = max < 2 ? 2 : max;
+    buffer = (int *) malloc(ringSize * sizeof(int));
+    sequence = malloc(ringSize * sizeof(*sequence));
+    consumedSum = malloc(slots * sizeof(*consumedSum));
+    consumedCount = malloc(slots * sizeof(*consumedCount));
+    if (buffer == NULL || sequence == NULL || consumedSum == NULL || consumedCount == NULL) {
+        printf("Allocation error!\n");
+        return 1;
+    }
+
+    int status = 0;
+    if (benchMode) {
+        status = bench(loops);
+    } else {
+        printf("main: begin (%s queue, %d producers, %d consumers, batches of %d)\n",
+               lockfree ? "lockfree" : "mutex", producers, consumers, batch);
+        double seconds = run();
+        if (seconds < 0) {
+            printf("main: items lost or duplicated\n");
+            status = 1;
+        } else {
+            for (int i = 0; i < consumers; i++) {
+                printf("Cid %d got %ld items\n", i, consumedCount[i]);
+            }
+            printf("main: %ld items in %.3f sec (%.0f ops/sec)\n", (long)producers * loops, seconds,
+                   producers * (double)loops / (seconds > 0 ? seconds : 1e-9));
+        }
+        printf("main: end\n");
+    }
+    free(buffer);
+    free(sequence);
+    free(consumedSum);
+    free(consumedCount);
+    return status;
  }
@@ -3,7 +3,10 @@
 
  Name: Jay Roy
  Date: 04/06/2025   
- Usage: ./program_name addresses_file
+ Usage: ./program_name [--mmap] [--quiet] addresses_file
+ Build: gcc -pthread -o program_name JayRoy_P4.c vmm.c pagetable.c invpt.c pagemap.c
+        writeback.c prefetch.c latency.c hugepage.c backing_store.c trace.c output.c tlb.c
+        replace.c
  CWID: 12342760
 
  This program simulates a virtual memory system with:
@@ -13,152 +16,131 @@
  * - 256 frames in physical memory
  * - 16-entry TLB with FIFO replacement
  * - On-demand paging with backing store
+ *
+ * The translation itself is the vmm library (see vmm.h) configured with
+ * one frame per page, so nothing is ever replaced; trace blocks go through
+ * it in one vmm_translate_batch call each.
  */
  
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "backing_store.h"
+#include "trace.h"
+#include "output.h"
+#include "vmm.h"
 
 // Constants
-#define PAGE_SIZE 256          // Size of each page/frame (in bytes)
-#define PAGE_TABLE_SIZE 256    // Number of entries in page table (pages)
-#define TLB_SIZE 16            // Number of entries in TLB
 #define FRAME_COUNT 256        // Number of frames in physical memory
-#define MEMORY_SIZE (FRAME_COUNT * PAGE_SIZE) // Total size of physical memory
-#define ADDRESS_MASK 0xFFFF    // Mask for extracting 16 least significant bits
-
-// TLB entry structure
-typedef struct {
-    int page_number;
-    int frame_number;
-    bool valid;
-} TLB_Entry;
+#define BACKING_STORE_FILE "BACKING_STORE.bin"
 
 // Global variables
-TLB_Entry tlb[TLB_SIZE];                      // TLB with 16 entries
-int page_table[PAGE_TABLE_SIZE];              // Page table with 256 entries
-signed char physical_memory[MEMORY_SIZE];     // Physical memory (65,536 bytes)
-FILE *backing_store;                          // File pointer for backing store
-int page_faults = 0;                          // Counter for page faults
-int tlb_hits = 0;                             // Counter for TLB hits
-int total_addresses = 0;                      // Counter for total addresses processed
-int free_frame = 0;                           // Next available frame index
-int tlb_index = 0;                            // Current index in TLB (for FIFO)
+Vmm *vm;                                      // Page table, TLB and physical memory
+BackingStore backing_store;                   // Backing store (pread or mmap)
+OutputBuffer output;                          // Buffered standard output
 
 int main(int argc, char *argv[]) {
+    // Separate options from positional arguments
+    bool use_mmap = false;
+    bool quiet = false;    // Only print the final statistics
+    char *positional[1] = {NULL};
+    int num_positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mmap") == 0) {
+            use_mmap = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            return -1;
+        } else if (num_positional < 1) {
+            positional[num_positional++] = argv[i];
+        } else {
+            num_positional++;
+        }
+    }
+
     // Check if correct number of arguments
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s addresses_file\n", argv[0]);
+    if (num_positional != 1) {
+        fprintf(stderr, "Usage: %s [--mmap] [--quiet] addresses_file\n", argv[0]);
         return -1;
     }
 
     // Open the addresses file
-    FILE *addresses_file = fopen(argv[1], "r");
-    if (addresses_file == NULL) {
-        fprintf(stderr, "Error: Could not open file %s\n", argv[1]);
+    TraceReader addresses_file;
+    if (trace_open(&addresses_file, positional[0]) != 0) {
+        fprintf(stderr, "Error: Could not open file %s\n", positional[0]);
         return -1;
     }
 
     // Open the backing store
-    backing_store = fopen("BACKING_STORE.bin", "rb");
-    if (backing_store == NULL) {
-        fprintf(stderr, "Error: Could not open BACKING_STORE.bin\n");
-        fclose(addresses_file);
+    if (backing_store_open(&backing_store, BACKING_STORE_FILE, PAGE_SIZE, use_mmap, false) != 0) {
+        fprintf(stderr, "Error: Could not open %s\n", BACKING_STORE_FILE);
+        trace_close(&addresses_file);
         return -1;
     }
 
-    // Initialize page table - all entries initially invalid (-1)
-    for (int i = 0; i < PAGE_TABLE_SIZE; i++) {
-        page_table[i] = -1;
+    // Create the page table, TLB (16 entries, FIFO) and physical memory
+    VmmConfig config;
+    vmm_config_init(&config);
+    config.frame_count = FRAME_COUNT;
+    config.policy = "fifo";
+    vm = vmm_create(&config, &backing_store);
+    if (vm == NULL) {
+        trace_close(&addresses_file);
+        backing_store_close(&backing_store);
+        return -1;
     }
 
-    // Initialize TLB - all entries initially invalid
-    for (int i = 0; i < TLB_SIZE; i++) {
-        tlb[i].valid = false;
-    }
+    output_init(&output, STDOUT_FILENO);
 
-    // Process addresses from the file
-    int logical_address;
-    while (fscanf(addresses_file, "%d", &logical_address) != EOF) {
-        total_addresses++;
-        
-        // Mask the logical address to get only the 16 least significant bits
-        logical_address = logical_address & ADDRESS_MASK;
-        
-        // Extract page number and offset from logical address
-        int page_number = logical_address >> 8;     // High 8 bits
-        int offset = logical_address & 0xFF;        // Low 8 bits
-        
-        int frame_number = -1;
-        bool tlb_hit = false;
-        
-        // Check TLB for page number
-        for (int i = 0; i < TLB_SIZE; i++) {
-            if (tlb[i].valid && tlb[i].page_number == page_number) {
-                frame_number = tlb[i].frame_number;
-                tlb_hit = true;
-                tlb_hits++;
-                break;
-            }
+    // Process addresses from the file, one decoded block at a time
+    static uint32_t logical[TRACE_BLOCK], physical[TRACE_BLOCK];
+    static int8_t values[TRACE_BLOCK];
+    while (trace_fill(&addresses_file)) {
+        size_t count = addresses_file.block_len;
+
+        // Mask the logical addresses to get only the 16 least significant bits
+        for (size_t i = 0; i < count; i++) {
+            logical[i] = (uint32_t)(addresses_file.block[i] & ADDRESS_MASK);
         }
-        
-        // If not in TLB, check page table
-        if (!tlb_hit) {
-            // Check if page is in page table
-            if (page_table[page_number] != -1) {
-                frame_number = page_table[page_number];
-            } else {
-                // Page fault - load from backing store
-                page_faults++;
-                
-                // Seek to page position in backing store
-                fseek(backing_store, page_number * PAGE_SIZE, SEEK_SET);
-                
-                // Read page into memory
-                signed char buffer[PAGE_SIZE];
-                fread(buffer, sizeof(signed char), PAGE_SIZE, backing_store);
-                
-                // Allocate a frame
-                frame_number = free_frame;
-                free_frame++;
-                
-                // Copy page into physical memory
-                for (int i = 0; i < PAGE_SIZE; i++) {
-                    physical_memory[frame_number * PAGE_SIZE + i] = buffer[i];
-                }
-                
-                // Update page table
-                page_table[page_number] = frame_number;
+
+        // Translate them and get the byte values from physical memory
+        if (vmm_translate_batch(vm, logical, count, physical, values) != 0) {
+            break;
+        }
+
+        // Output the address translations
+        if (!quiet) {
+            for (size_t i = 0; i < count; i++) {
+                output_translation(&output, logical[i], physical[i], values[i]);
             }
-            
-            // Update TLB (FIFO replacement)
-            tlb[tlb_index].page_number = page_number;
-            tlb[tlb_index].frame_number = frame_number;
-            tlb[tlb_index].valid = true;
-            tlb_index = (tlb_index + 1) % TLB_SIZE;
         }
-        
-        // Calculate physical address
-        int physical_address = frame_number * PAGE_SIZE + offset;
-        
-        // Get byte value from physical memory
-        signed char value = physical_memory[physical_address];
-        
-        // Output the address translation
-        printf("Virtual address: %d Physical address: %d Value: %d\n", 
-               logical_address, physical_address, value);
     }
-    
+    if (vm->failed || addresses_file.error) {
+        output_flush(&output);
+        vmm_destroy(vm);
+        trace_close(&addresses_file);
+        backing_store_close(&backing_store);
+        return -1;
+    }
+
     // Print statistics
-    printf("\nNumber of Translated Addresses = %d\n", total_addresses);
-    printf("Page Faults = %d\n", page_faults);
-    printf("Page Fault Rate = %.3f\n", (double)page_faults / total_addresses);
-    printf("TLB Hits = %d\n", tlb_hits);
-    printf("TLB Hit Rate = %.3f\n", (double)tlb_hits / total_addresses);
+    VmmStats stats;
+    vmm_get_stats(vm, &stats);
+    output_printf(&output, "\nNumber of Translated Addresses = %ld\n", stats.references);
+    output_printf(&output, "Page Faults = %ld\n", stats.page_faults);
+    output_printf(&output, "Page Fault Rate = %.3f\n", (double)stats.page_faults / stats.references);
+    output_printf(&output, "TLB Hits = %ld\n", stats.tlb_hits);
+    output_printf(&output, "TLB Hit Rate = %.3f\n", (double)stats.tlb_hits / stats.references);
+    output_flush(&output);
     
     // Close files
-    fclose(addresses_file);
-    fclose(backing_store);
+    vmm_destroy(vm);
+    trace_close(&addresses_file);
+    backing_store_close(&backing_store);
     
     return 0;
 }
\ No newline at end of file
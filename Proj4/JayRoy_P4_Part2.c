@@ -3,261 +3,705 @@
  * 
  * Name: Jay Roy
  * Date: 04/06/2025
- * Usage: ./program_name addresses_file [frame_count]
+ * Usage: ./program_name [--mmap] [--quiet] [--store FILE] [--writable]
+ *        [--writeback-batch N] [--async-writeback] [--prefetch NAME] [--prefetch-degree N]
+ *        [--prefetch-frames N] [--address-bits N] [--page-size N]
+ *        [--page-table NAME] [--pt-levels N] [--policy NAME] [--ws-window N] [--pff-interval N]
+ *        [--tlb-size N] [--tlb-ways N] [--tlb-policy NAME]
+ *        [--l2-tlb-size N] [--l2-tlb-ways N] [--l2-tlb-policy NAME] [--tlb-inclusion NAME]
+ *        [--l1-tlb-ns T] [--l2-tlb-ns T] [--walk-ns T] [--memory-ns T] [--fault-us T]
+ *        [--latency] [--huge-pages LIST] [--promote-percent P]
+ *        [--sweep [--sweep-frames LIST] [--sweep-tlb-sizes LIST] [--sweep-policies LIST]
+ *         [--threads N] [--csv FILE]] [--stack-distance]
+ *        [--profile [--profile-window N] [--top-k K] [--profile-samples N] [--csv FILE]]
+ *        addresses_file [frame_count]
+ * Build: gcc -pthread -o program_name JayRoy_P4_Part2.c vmm.c pagetable.c invpt.c pagemap.c
+ *        writeback.c prefetch.c latency.c hugepage.c sweep.c stackdist.c profile.c backing_store.c
+ *        trace.c output.c tlb.c replace.c
  * CWID: 12342760
  * 
  * This program extends Part 1 by:
  * - Supporting variable-sized physical memory (fewer frames than virtual pages)
  * - Implementing LRU page replacement when physical memory is full
  * 
+ * --address-bits (16-64, default 16) and --page-size (default 256) set the
+ * address geometry. Wider address spaces use a radix page table of
+ * --pt-levels levels (1-4, default about 10 index bits per level) whose
+ * tables are allocated on first touch; its size is reported at the end.
+ * --page-table inverted replaces it with an inverted page table whose size
+ * depends only on the frame count.
+ * 
+ * Traces may mark addresses as reads or writes (see trace.h). Writes set
+ * the page's dirty bit; with --writable, dirty pages are written back to
+ * the --store file (default BACKING_STORE.bin, otherwise never modified)
+ * in batches of --writeback-batch pages, on a background thread with
+ * --async-writeback, and once more for pages still dirty at exit.
+ * 
+ * --prefetch sequential, stride or markov predicts --prefetch-degree
+ * (default 2) pages after every fault and reads them on a background
+ * thread into --prefetch-frames (default 16) staging frames; accuracy
+ * (staged pages used / issued), coverage (faults served from staging /
+ * all faults) and the demand reads avoided are reported at the end.
+ * 
+ * The replacement policy is pluggable (see replace.h) and chosen with
+ * --policy: fifo, lru (default), clock, lfu, arc, or opt. A frame-to-page
+ * reverse map identifies the page to invalidate on eviction.
+ * 
+ * Traces may interleave several processes by tagging addresses with an
+ * ASID (see trace.h). Each process has its own page table, TLB entries are
+ * tagged with the ASID, and the processes share the frames. The policies
+ * above replace globally; --policy ws (working set, --ws-window
+ * references, default 1000) and pff (page fault frequency, --pff-interval
+ * references, default 100) allocate frames per process. Per-process
+ * references, faults and resident frames are reported at the end.
+ * 
+ * The TLB geometry is configurable: --tlb-size entries, --tlb-ways entries
+ * per set (0 = fully associative, the default; 1 = direct-mapped), and
+ * --tlb-policy fifo (default), lru, random, or plru within each set.
+ * 
+ * An optional second-level TLB (--l2-tlb-size > 0) sits behind it with its
+ * own geometry and a --tlb-inclusion of inclusive (default), exclusive, or
+ * nine. With an L2 the statistics also break hits down per level and
+ * estimate the average memory access time, excluding fault service.
+ * 
+ * Every reference is charged a simulated latency: --l1-tlb-ns (0.5),
+ * --l2-tlb-ns on an L1 miss with an L2 (3.5), --walk-ns per page table
+ * level on a TLB miss (20), --memory-ns (80) and --fault-us when a fault
+ * reads the backing store (100). --latency reports the total simulated
+ * time, the effective access time, p50/p99 reference latencies and the
+ * time lost to faults.
+ * 
+ * --huge-pages lists huge page sizes in base pages (e.g. 16,512) mapped
+ * alongside base pages. A region is promoted to the largest size of which
+ * --promote-percent (default 50) of its base pages are resident: its
+ * other pages are loaded and one TLB entry then covers it. Evicting any
+ * of its pages splits it again. Promotions, splits, pages loaded to fill
+ * regions, huge TLB hits and the mean TLB reach are reported; compare the
+ * fault rate with and without huge pages to see whether they pay off.
+ * 
+ * --sweep loads the trace once and simulates every combination of
+ * --sweep-frames (default 1-256), --sweep-tlb-sizes and --sweep-policies
+ * (default: the single --tlb-size / --policy) on --threads worker threads
+ * (default: one per core), writing fault and hit rates and the effective
+ * and p99 access times as CSV.
+ * 
+ * --profile streams the trace once through a bounded-memory profiler (see
+ * profile.h) instead of simulating it: working-set sizes over windows of
+ * --profile-window references (default 10000) and the phase changes
+ * between them, the --top-k (default 10) most referenced pages, and a
+ * reuse distance histogram from --profile-samples (default 8192) sampled
+ * pages, with the frame counts LRU needs to hit 50-99% of reuses. --csv
+ * writes the per-window working sets.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "backing_store.h"
+#include "trace.h"
+#include "output.h"
+#include "vmm.h"
+#include "sweep.h"
+#include "stackdist.h"
+#include "profile.h"
 
 // Constants
-#define PAGE_SIZE 256          // Size of each page/frame (in bytes)
-#define PAGE_TABLE_SIZE 256    // Number of entries in page table (pages)
-#define TLB_SIZE 16            // Number of entries in TLB
 #define DEFAULT_FRAME_COUNT 128 // Default number of frames if not specified
-#define MAX_FRAMES 256         // Maximum possible frames
-#define ADDRESS_MASK 0xFFFF    // Mask for extracting 16 least significant bits
-
-// TLB entry structure
-typedef struct {
-    int page_number;
-    int frame_number;
-    bool valid;
-} TLB_Entry;
-
-// Page table entry with validity flag
-typedef struct {
-    int frame_number;
-    bool valid;
-} PageTableEntry;
+#define BACKING_STORE_FILE "BACKING_STORE.bin"
 
 // Global variables
-TLB_Entry tlb[TLB_SIZE];                      // TLB with 16 entries
-PageTableEntry page_table[PAGE_TABLE_SIZE];   // Page table with 256 entries
-signed char *physical_memory;                 // Physical memory (dynamically allocated)
-int *frame_last_used;                         // Array to track when each frame was last used
-int frame_count;                              // Number of frames in physical memory
-FILE *backing_store;                          // File pointer for backing store
-int page_faults = 0;                          // Counter for page faults
-int tlb_hits = 0;                             // Counter for TLB hits
-int total_addresses = 0;                      // Counter for total addresses processed
-int free_frame = 0;                           // Next available frame index (up to frame_count)
-int tlb_index = 0;                            // Current index in TLB (for FIFO)
-int current_time = 0;                         // Clock for LRU algorithm
-
-// Function to find the least recently used frame
-int find_lru_frame() {
-    int lru_frame = 0;
-    int min_time = INT_MAX;
-    
-    for (int i = 0; i < frame_count; i++) {
-        if (frame_last_used[i] < min_time) {
-            min_time = frame_last_used[i];
-            lru_frame = i;
+Vmm *vm;                                      // Page table, TLBs, frames and replacement policy
+BackingStore backing_store;                   // Backing store (pread or mmap)
+OutputBuffer output;                          // Buffered standard output
+
+// Sweep mode: simulate a grid of configurations in parallel and write CSV
+int run_sweep(VmmConfig *config, const char *trace_path, const char *frames_spec,
+              const char *tlb_sizes_spec, const char *policies_spec, int threads,
+              const char *csv_path) {
+    int num_frames, num_tlb_sizes, num_policies;
+    int *frames = sweep_parse_ints(frames_spec, &num_frames);
+    int *tlb_sizes = sweep_parse_ints(tlb_sizes_spec, &num_tlb_sizes);
+    char **policies = sweep_parse_names(policies_spec, &num_policies);
+    if (frames == NULL || tlb_sizes == NULL || policies == NULL) {
+        fprintf(stderr, "Error: Invalid sweep list (use e.g. 1-256, 1-256:8, 8,16,32 or lru,fifo)\n");
+        free(frames);
+        free(tlb_sizes);
+        sweep_free_names(policies);
+        return -1;
+    }
+
+    // Load the trace once; every worker reads the same array
+    long count = 0;
+    uint16_t *asids = NULL;
+    uint64_t *addresses = trace_load(trace_path, &count, &asids);
+    long *next_use = NULL;
+    bool needs_opt = false;
+    for (int p = 0; p < num_policies; p++) {
+        needs_opt = needs_opt || strcmp(policies[p], "opt") == 0;
+    }
+    if (addresses != NULL && needs_opt) {
+        next_use = vmm_next_use(config, addresses, asids, count);
+    }
+
+    int num_jobs = num_frames * num_tlb_sizes * num_policies;
+    SweepJob *jobs = calloc(num_jobs, sizeof(SweepJob));
+    FILE *csv = csv_path == NULL ? stdout : fopen(csv_path, "w");
+    int status = -1;
+    if (addresses == NULL) {
+        fprintf(stderr, "Error: Could not load file %s\n", trace_path);
+    } else if ((needs_opt && next_use == NULL) || jobs == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+    } else if (csv == NULL) {
+        fprintf(stderr, "Error: Could not open file %s\n", csv_path);
+    } else {
+        int j = 0;
+        for (int p = 0; p < num_policies; p++) {
+            for (int t = 0; t < num_tlb_sizes; t++) {
+                for (int f = 0; f < num_frames; f++) {
+                    jobs[j].frame_count = frames[f];
+                    jobs[j].tlb_size = tlb_sizes[t];
+                    jobs[j].policy = policies[p];
+                    j++;
+                }
+            }
+        }
+
+        config->next_use = next_use;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        status = sweep_run(config, addresses, asids, count, jobs, num_jobs, threads);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if (status == 0) {
+            sweep_write_csv(csv, config, jobs, num_jobs);
+            fprintf(stderr, "Simulated %d configurations x %ld addresses in %.3f sec on %d threads\n",
+                    num_jobs, count,
+                    (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9,
+                    threads < num_jobs ? threads : num_jobs);
         }
     }
-    
-    return lru_frame;
+
+    if (csv != NULL && csv != stdout) {
+        fclose(csv);
+    }
+    free(jobs);
+    free(next_use);
+    free(addresses);
+    free(asids);
+    free(frames);
+    free(tlb_sizes);
+    sweep_free_names(policies);
+    return status;
 }
 
-// Function to find which page is using a specific frame
-int find_page_using_frame(int frame) {
-    for (int i = 0; i < PAGE_TABLE_SIZE; i++) {
-        if (page_table[i].valid && page_table[i].frame_number == frame) {
-            return i;
+// Stack distance mode: LRU page faults for every listed frame count in one pass
+int run_stack_distance(const VmmConfig *config, const char *trace_path, const char *frames_spec,
+                       const char *csv_path) {
+    int num_frames;
+    int *frames = sweep_parse_ints(frames_spec, &num_frames);
+    if (frames == NULL) {
+        fprintf(stderr, "Error: Invalid frame list (use e.g. 1-256, 1-256:8 or 8,16,32)\n");
+        return -1;
+    }
+    int max_frames = 0;
+    for (int f = 0; f < num_frames; f++) {
+        max_frames = frames[f] > max_frames ? frames[f] : max_frames;
+    }
+
+    // A statistics-only Vmm validates the geometry and decodes page numbers
+    VmmConfig probe = *config;
+    probe.frame_count = 1;
+    Vmm *decoder = vmm_create(&probe, NULL);
+    if (decoder == NULL) {
+        free(frames);
+        return -1;
+    }
+
+    TraceReader addresses_file;
+    if (trace_open(&addresses_file, trace_path) != 0) {
+        fprintf(stderr, "Error: Could not open file %s\n", trace_path);
+        vmm_destroy(decoder);
+        free(frames);
+        return -1;
+    }
+
+    StackDistance sd;
+    int status = stackdist_init(&sd, max_frames);
+    uint64_t next_address;
+    bool write;
+    uint16_t asid;
+    while (status == 0 && trace_next_ref(&addresses_file, &next_address, &write, &asid)) {
+        status = stackdist_reference(&sd, vmm_page_key(decoder, asid, next_address));
+    }
+    bool malformed = addresses_file.error;
+    trace_close(&addresses_file);
+    vmm_destroy(decoder);
+
+    FILE *csv = csv_path == NULL ? stdout : fopen(csv_path, "w");
+    if (status != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+    } else if (malformed) {
+        status = -1;
+    } else if (csv == NULL) {
+        fprintf(stderr, "Error: Could not open file %s\n", csv_path);
+        status = -1;
+    } else {
+        fprintf(csv, "frames,references,page_faults,page_fault_rate\n");
+        for (int f = 0; f < num_frames; f++) {
+            long faults = stackdist_faults(&sd, frames[f]);
+            fprintf(csv, "%d,%ld,%ld,%.6f\n", frames[f], sd.references, faults,
+                    sd.references > 0 ? (double)faults / sd.references : 0.0);
+        }
+    }
+    if (csv != NULL && csv != stdout) {
+        fclose(csv);
+    }
+    stackdist_destroy(&sd);
+    free(frames);
+    return status;
+}
+
+// Profile mode: working sets, phases, popular pages and reuse distances in one pass
+int run_profile(const VmmConfig *config, const char *trace_path, long window, int top_k,
+                int samples, const char *csv_path) {
+    // A statistics-only Vmm validates the geometry and decodes page numbers
+    VmmConfig probe = *config;
+    probe.frame_count = 1;
+    Vmm *decoder = vmm_create(&probe, NULL);
+    if (decoder == NULL) {
+        return -1;
+    }
+
+    TraceReader addresses_file;
+    if (trace_open(&addresses_file, trace_path) != 0) {
+        fprintf(stderr, "Error: Could not open file %s\n", trace_path);
+        vmm_destroy(decoder);
+        return -1;
+    }
+    FILE *csv = NULL;
+    if (csv_path != NULL && (csv = fopen(csv_path, "w")) == NULL) {
+        fprintf(stderr, "Error: Could not open file %s\n", csv_path);
+        trace_close(&addresses_file);
+        vmm_destroy(decoder);
+        return -1;
+    }
+
+    Profile profile;
+    if (profile_init(&profile, window, top_k, samples, csv) != 0) {
+        fprintf(stderr, "Error: Invalid profile settings (window and samples must be positive,\n"
+                        "       top-k 0-%d) or memory allocation failed\n", MAX_TOP_K);
+        if (csv != NULL) {
+            fclose(csv);
         }
+        trace_close(&addresses_file);
+        vmm_destroy(decoder);
+        return -1;
+    }
+
+    int status = 0;
+    uint64_t next_address;
+    bool write;
+    uint16_t asid;
+    while (status == 0 && trace_next_ref(&addresses_file, &next_address, &write, &asid)) {
+        status = profile_reference(&profile, vmm_page_key(decoder, asid, next_address));
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+    } else if (addresses_file.error) {
+        status = -1;
+    } else {
+        profile_finish(&profile);
+        profile_report(&profile, stdout, decoder->vpn_bits, addresses_file.has_asids);
     }
-    return -1; // Not found
+
+    profile_destroy(&profile);
+    if (csv != NULL) {
+        fclose(csv);
+    }
+    trace_close(&addresses_file);
+    vmm_destroy(decoder);
+    return status;
 }
 
 int main(int argc, char *argv[]) {
+    // Separate options from positional arguments
+    VmmConfig config;
+    vmm_config_init(&config);
+    bool use_mmap = false;
+    const char *store_path = BACKING_STORE_FILE;
+    bool writable = false;   // Write dirty pages back to the store
+    bool quiet = false;    // Only print the final statistics
+    bool latency = false;
+    const char *huge_pages_spec = NULL;
+    bool sweep = false;
+    bool stack_distance = false;
+    bool profile = false;
+    long profile_window = PROFILE_WINDOW;
+    int top_k = PROFILE_TOP_K;
+    int profile_samples = PROFILE_SAMPLES;
+    const char *sweep_frames = "1-256";
+    const char *sweep_tlb_sizes = NULL;
+    const char *sweep_policies = NULL;
+    const char *csv_path = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    char *positional[2] = {NULL, NULL};
+    int num_positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mmap") == 0) {
+            use_mmap = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (strcmp(argv[i], "--writable") == 0) {
+            writable = true;
+        } else if (strcmp(argv[i], "--writeback-batch") == 0 && i + 1 < argc) {
+            config.writeback_batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--async-writeback") == 0) {
+            config.async_writeback = true;
+        } else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+            config.prefetch = argv[++i];
+        } else if (strcmp(argv[i], "--prefetch-degree") == 0 && i + 1 < argc) {
+            config.prefetch_degree = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--prefetch-frames") == 0 && i + 1 < argc) {
+            config.prefetch_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--address-bits") == 0 && i + 1 < argc) {
+            config.address_bits = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--page-size") == 0 && i + 1 < argc) {
+            config.page_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--page-table") == 0 && i + 1 < argc) {
+            config.page_table = argv[++i];
+        } else if (strcmp(argv[i], "--pt-levels") == 0 && i + 1 < argc) {
+            config.page_table_levels = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            config.policy = argv[++i];
+        } else if (strcmp(argv[i], "--ws-window") == 0 && i + 1 < argc) {
+            config.ws_window = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--pff-interval") == 0 && i + 1 < argc) {
+            config.pff_interval = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--tlb-size") == 0 && i + 1 < argc) {
+            config.tlb_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tlb-ways") == 0 && i + 1 < argc) {
+            config.tlb_ways = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tlb-policy") == 0 && i + 1 < argc) {
+            config.tlb_policy = argv[++i];
+        } else if (strcmp(argv[i], "--l2-tlb-size") == 0 && i + 1 < argc) {
+            config.l2_tlb_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--l2-tlb-ways") == 0 && i + 1 < argc) {
+            config.l2_tlb_ways = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--l2-tlb-policy") == 0 && i + 1 < argc) {
+            config.l2_tlb_policy = argv[++i];
+        } else if (strcmp(argv[i], "--tlb-inclusion") == 0 && i + 1 < argc) {
+            config.tlb_inclusion = argv[++i];
+        } else if (strcmp(argv[i], "--l1-tlb-ns") == 0 && i + 1 < argc) {
+            config.cost.l1_tlb_ns = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--l2-tlb-ns") == 0 && i + 1 < argc) {
+            config.cost.l2_tlb_ns = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--walk-ns") == 0 && i + 1 < argc) {
+            config.cost.walk_ns = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--memory-ns") == 0 && i + 1 < argc) {
+            config.cost.memory_ns = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fault-us") == 0 && i + 1 < argc) {
+            config.cost.fault_us = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            latency = true;
+        } else if (strcmp(argv[i], "--huge-pages") == 0 && i + 1 < argc) {
+            huge_pages_spec = argv[++i];
+        } else if (strcmp(argv[i], "--promote-percent") == 0 && i + 1 < argc) {
+            config.promote_percent = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = true;
+        } else if (strcmp(argv[i], "--sweep-frames") == 0 && i + 1 < argc) {
+            sweep_frames = argv[++i];
+        } else if (strcmp(argv[i], "--sweep-tlb-sizes") == 0 && i + 1 < argc) {
+            sweep_tlb_sizes = argv[++i];
+        } else if (strcmp(argv[i], "--sweep-policies") == 0 && i + 1 < argc) {
+            sweep_policies = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stack-distance") == 0) {
+            stack_distance = true;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--profile-window") == 0 && i + 1 < argc) {
+            profile_window = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--top-k") == 0 && i + 1 < argc) {
+            top_k = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profile-samples") == 0 && i + 1 < argc) {
+            profile_samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[i]);
+            return -1;
+        } else if (num_positional < 2) {
+            positional[num_positional++] = argv[i];
+        } else {
+            num_positional++;
+        }
+    }
+
     // Check if correct number of arguments
-    if (argc < 2 || argc > 3) {
-        fprintf(stderr, "Usage: %s addresses_file [frame_count]\n", argv[0]);
+    if (num_positional < 1 || num_positional > 2) {
+        fprintf(stderr, "Usage: %s [--mmap] [--quiet] [--store FILE] [--writable] [--writeback-batch N]\n"
+                        "       [--async-writeback] [--prefetch NAME] [--prefetch-degree N]\n"
+                        "       [--prefetch-frames N] [--address-bits N] [--page-size N] [--page-table NAME]\n"
+                        "       [--pt-levels N] [--policy NAME] [--ws-window N] [--pff-interval N]\n"
+                        "       [--tlb-size N] [--tlb-ways N] [--tlb-policy NAME]\n"
+                        "       [--l2-tlb-size N] [--l2-tlb-ways N] [--l2-tlb-policy NAME]\n"
+                        "       [--tlb-inclusion NAME] [--l1-tlb-ns T] [--l2-tlb-ns T] [--walk-ns T]\n"
+                        "       [--memory-ns T] [--fault-us T] [--latency] [--huge-pages LIST]\n"
+                        "       [--promote-percent P]\n"
+                        "       [--sweep [--sweep-frames LIST] [--sweep-tlb-sizes LIST]\n"
+                        "       [--sweep-policies LIST] [--threads N] [--csv FILE]] [--stack-distance]\n"
+                        "       [--profile [--profile-window N] [--top-k K] [--profile-samples N]\n"
+                        "       [--csv FILE]]\n"
+                        "       addresses_file [frame_count]\n", argv[0]);
+        fprintf(stderr, "       policies: %s; TLB policies: %s; inclusion: %s; page tables: %s;\n"
+                        "       prefetchers: %s\n",
+                POLICY_NAMES, TLB_POLICY_NAMES, TLB_INCLUSION_NAMES, PAGE_TABLE_NAMES, PREFETCH_NAMES);
         return -1;
     }
 
+    // Huge page sizes, e.g. 16,512
+    int huge_pages[MAX_HUGE_SIZES];
+    if (huge_pages_spec != NULL) {
+        int count;
+        int *sizes = sweep_parse_ints(huge_pages_spec, &count);
+        if (sizes == NULL || count > MAX_HUGE_SIZES) {
+            fprintf(stderr, "Error: Invalid huge page list %s (up to %d sizes, e.g. 16,512)\n",
+                    huge_pages_spec, MAX_HUGE_SIZES);
+            free(sizes);
+            return -1;
+        }
+        memcpy(huge_pages, sizes, count * sizeof(int));
+        free(sizes);
+        config.huge_pages = huge_pages;
+        config.huge_page_count = count;
+    }
+
+    if (profile) {
+        return run_profile(&config, positional[0], profile_window, top_k, profile_samples,
+                           csv_path) == 0 ? 0 : -1;
+    }
+
+    if (stack_distance) {
+        return run_stack_distance(&config, positional[0], sweep_frames, csv_path) == 0 ? 0 : -1;
+    }
+
+    if (sweep) {
+        char tlb_size_text[16];
+        snprintf(tlb_size_text, sizeof(tlb_size_text), "%d", config.tlb_size);
+        if (threads <= 0) {
+            threads = 1;
+        }
+        return run_sweep(&config, positional[0], sweep_frames,
+                         sweep_tlb_sizes != NULL ? sweep_tlb_sizes : tlb_size_text,
+                         sweep_policies != NULL ? sweep_policies : config.policy,
+                         threads, csv_path) == 0 ? 0 : -1;
+    }
+
     // Determine the number of frames in physical memory
-    if (argc == 3) {
-        frame_count = atoi(argv[2]);
-        if (frame_count <= 0 || frame_count > MAX_FRAMES) {
-            fprintf(stderr, "Error: Frame count must be between 1 and %d\n", MAX_FRAMES);
+    if (num_positional == 2) {
+        config.frame_count = atoi(positional[1]);
+        int max_frames = vmm_max_frames(&config);
+        if (config.frame_count <= 0 || config.frame_count > max_frames) {
+            fprintf(stderr, "Error: Frame count must be between 1 and %d\n", max_frames);
             return -1;
         }
     } else {
-        frame_count = DEFAULT_FRAME_COUNT;
+        config.frame_count = DEFAULT_FRAME_COUNT;
     }
 
     // Open the addresses file
-    FILE *addresses_file = fopen(argv[1], "r");
-    if (addresses_file == NULL) {
-        fprintf(stderr, "Error: Could not open file %s\n", argv[1]);
+    TraceReader addresses_file;
+    if (trace_open(&addresses_file, positional[0]) != 0) {
+        fprintf(stderr, "Error: Could not open file %s\n", positional[0]);
         return -1;
     }
 
     // Open the backing store
-    backing_store = fopen("BACKING_STORE.bin", "rb");
-    if (backing_store == NULL) {
-        fprintf(stderr, "Error: Could not open BACKING_STORE.bin\n");
-        fclose(addresses_file);
+    if (backing_store_open(&backing_store, store_path, config.page_size, use_mmap, writable) != 0) {
+        fprintf(stderr, "Error: Could not open %s\n", store_path);
+        trace_close(&addresses_file);
         return -1;
     }
 
-    // Allocate physical memory based on frame count
-    physical_memory = (signed char *)malloc(frame_count * PAGE_SIZE);
-    if (physical_memory == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        fclose(addresses_file);
-        fclose(backing_store);
-        return -1;
+    // OPT needs to know the future: precompute next-use indices for the trace
+    long *next_use = NULL;
+    if (strcmp(config.policy, "opt") == 0) {
+        long count = 0;
+        uint16_t *asids = NULL;
+        uint64_t *addresses = trace_load(positional[0], &count, &asids);
+        if (addresses != NULL) {
+            next_use = vmm_next_use(&config, addresses, asids, count);
+            free(addresses);
+            free(asids);
+        }
+        if (next_use == NULL) {
+            fprintf(stderr, "Error: Could not precompute next uses for OPT\n");
+            trace_close(&addresses_file);
+            backing_store_close(&backing_store);
+            return -1;
+        }
+        config.next_use = next_use;
     }
 
-    // Allocate and initialize frame usage tracking
-    frame_last_used = (int *)malloc(frame_count * sizeof(int));
-    if (frame_last_used == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        free(physical_memory);
-        fclose(addresses_file);
-        fclose(backing_store);
+    // Create the page table, TLBs, physical memory and replacement policy
+    vm = vmm_create(&config, &backing_store);
+    if (vm == NULL) {
+        free(next_use);
+        trace_close(&addresses_file);
+        backing_store_close(&backing_store);
         return -1;
     }
-    
-    for (int i = 0; i < frame_count; i++) {
-        frame_last_used[i] = -1; // Initialize to -1 (never used)
-    }
-
-    // Initialize page table - all entries initially invalid
-    for (int i = 0; i < PAGE_TABLE_SIZE; i++) {
-        page_table[i].valid = false;
-    }
-
-    // Initialize TLB - all entries initially invalid
-    for (int i = 0; i < TLB_SIZE; i++) {
-        tlb[i].valid = false;
-    }
-
-    printf("# of frames: %d \n", frame_count);
-
-    // Process addresses from the file
-    int logical_address;
-    while (fscanf(addresses_file, "%d", &logical_address) != EOF) {
-        total_addresses++;
-        current_time++; // Increment time for LRU
-        
-        // Mask the logical address to get only the 16 least significant bits
-        logical_address = logical_address & ADDRESS_MASK;
-        
-        // Extract page number and offset from logical address
-        int page_number = logical_address >> 8;     // High 8 bits
-        int offset = logical_address & 0xFF;        // Low 8 bits
-        
-        int frame_number = -1;
-        bool tlb_hit = false;
-        
-        // Check TLB for page number
-        for (int i = 0; i < TLB_SIZE; i++) {
-            if (tlb[i].valid && tlb[i].page_number == page_number) {
-                frame_number = tlb[i].frame_number;
-                tlb_hit = true;
-                tlb_hits++;
-                // Update the last used time for this frame
-                frame_last_used[frame_number] = current_time;
+
+    output_init(&output, STDOUT_FILENO);
+    output_printf(&output, "# of frames: %d \n", config.frame_count);
+
+    // Process addresses from the file, one decoded block at a time. Blocks
+    // of plain reads by process 0 go through the batch interface.
+    static uint32_t logical[TRACE_BLOCK], physical[TRACE_BLOCK];
+    static int8_t values[TRACE_BLOCK];
+    bool batch = vm->address_mask <= UINT32_MAX && vmm_batch_ok(vm);
+    while (!vm->failed && trace_fill(&addresses_file)) {
+        size_t count = addresses_file.block_len;
+        if (batch && !addresses_file.has_writes && !addresses_file.has_asids) {
+            // Mask the logical addresses to the configured width (16 bits by default)
+            for (size_t i = 0; i < count; i++) {
+                logical[i] = (uint32_t)(addresses_file.block[i] & vm->address_mask);
+            }
+            if (vmm_translate_batch(vm, logical, count, physical, values) != 0) {
                 break;
             }
-        }
-        
-        // If not in TLB, check page table
-        if (!tlb_hit) {
-            // Check if page is in page table
-            if (page_table[page_number].valid) {
-                frame_number = page_table[page_number].frame_number;
-                // Update the last used time for this frame
-                frame_last_used[frame_number] = current_time;
-            } else {
-                // Page fault - load from backing store
-                page_faults++;
-                
-                // Seek to page position in backing store
-                fseek(backing_store, page_number * PAGE_SIZE, SEEK_SET);
-                
-                // Read page into a temporary buffer
-                signed char buffer[PAGE_SIZE];
-                fread(buffer, sizeof(signed char), PAGE_SIZE, backing_store);
-                
-                // Allocate a frame - either a free one or replace using LRU
-                if (free_frame < frame_count) {
-                    // We still have free frames available
-                    frame_number = free_frame;
-                    free_frame++;
-                } else {
-                    // No free frames - use LRU replacement
-                    frame_number = find_lru_frame();
-                    
-                    // Find which page is using this frame
-                    int old_page = find_page_using_frame(frame_number);
-                    if (old_page != -1) {
-                        // Invalidate the page table entry
-                        page_table[old_page].valid = false;
-                        
-                        // Also invalidate any TLB entries referencing this page
-                        for (int i = 0; i < TLB_SIZE; i++) {
-                            if (tlb[i].valid && tlb[i].page_number == old_page) {
-                                tlb[i].valid = false;
-                                break;
-                            }
-                        }
-                    }
-                }
-                
-                // Copy page into physical memory frame
-                for (int i = 0; i < PAGE_SIZE; i++) {
-                    physical_memory[frame_number * PAGE_SIZE + i] = buffer[i];
+            if (!quiet) {
+                for (size_t i = 0; i < count; i++) {
+                    output_translation(&output, logical[i], physical[i], values[i]);
                 }
-                
-                // Update page table
-                page_table[page_number].frame_number = frame_number;
-                page_table[page_number].valid = true;
-                
-                // Update the last used time for this frame
-                frame_last_used[frame_number] = current_time;
             }
-            
-            // Update TLB (FIFO replacement)
-            tlb[tlb_index].page_number = page_number;
-            tlb[tlb_index].frame_number = frame_number;
-            tlb[tlb_index].valid = true;
-            tlb_index = (tlb_index + 1) % TLB_SIZE;
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t logical_address = addresses_file.block[i] & vm->address_mask;
+
+            // Translate it and get the byte value from physical memory
+            signed char value;
+            uint64_t physical_address = vmm_access_asid(vm, addresses_file.asids[i], logical_address,
+                                                        addresses_file.writes[i] != 0, &value);
+            if (vm->failed) {
+                break;
+            }
+
+            // Output the address translation
+            if (!quiet) {
+                output_translation(&output, logical_address, physical_address, value);
+            }
         }
-        
-        // Calculate physical address
-        int physical_address = frame_number * PAGE_SIZE + offset;
-        
-        // Get byte value from physical memory
-        signed char value = physical_memory[physical_address];
-        
-        // Output the address translation
-        printf("Virtual address: %d Physical address: %d Value: %d\n", 
-               logical_address, physical_address, value);
+    }
+    if (vm->failed || addresses_file.error) {
+        output_flush(&output);
+        vmm_destroy(vm);
+        free(next_use);
+        trace_close(&addresses_file);
+        backing_store_close(&backing_store);
+        return -1;
     }
     
+    // Write back pages still dirty in memory
+    vmm_sync(vm);
+    VmmStats stats;
+    vmm_get_stats(vm, &stats);
+    if (stats.writes > 0 && !writable) {
+        fprintf(stderr, "Note: %s is read-only; dirty pages were counted but not written "
+                        "(use --writable)\n", store_path);
+    }
+
     // Print statistics
-    printf("\nNumber of Translated Addresses = %d\n", total_addresses);
-    printf("Page Faults = %d\n", page_faults);
-    printf("Page Fault Rate = %.3f\n", (double)page_faults / total_addresses);
-    printf("TLB Hits = %d\n", tlb_hits);
-    printf("TLB Hit Rate = %.3f\n", (double)tlb_hits / total_addresses);
+    long total_addresses = stats.references;
+    output_printf(&output, "\nNumber of Translated Addresses = %ld\n", total_addresses);
+    output_printf(&output, "Page Faults = %ld\n", stats.page_faults);
+    output_printf(&output, "Page Fault Rate = %.3f\n", (double)stats.page_faults / total_addresses);
+    output_printf(&output, "TLB Hits = %ld\n", stats.tlb_hits);
+    output_printf(&output, "TLB Hit Rate = %.3f\n", (double)stats.tlb_hits / total_addresses);
+    if (vm->tlbs.has_l2) {
+        double amat = (stats.simulated_ns - stats.fault_ns) / total_addresses;
+        output_printf(&output, "L1 TLB Hits = %ld\n", stats.l1_tlb_hits);
+        output_printf(&output, "L2 TLB Hits = %ld\n", stats.l2_tlb_hits);
+        output_printf(&output, "Page Walks = %ld\n", stats.page_walks);
+        output_printf(&output, "Estimated AMAT = %.2f ns (excluding page fault service)\n", amat);
+    }
+    if (latency) {
+        output_printf(&output, "Simulated Time = %.3f ms\n", stats.simulated_ns / 1e6);
+        output_printf(&output, "Effective Access Time = %.2f ns\n", stats.simulated_ns / total_addresses);
+        output_printf(&output, "Latency p50 = %.2f ns\n", latency_percentile(&vm->latency, 0.50));
+        output_printf(&output, "Latency p99 = %.2f ns\n", latency_percentile(&vm->latency, 0.99));
+        output_printf(&output, "Time Lost to Page Faults = %.3f ms (%.1f%%)\n", stats.fault_ns / 1e6,
+                      stats.simulated_ns > 0 ? 100.0 * stats.fault_ns / stats.simulated_ns : 0.0);
+    }
+    if (stats.writes > 0) {
+        output_printf(&output, "Writes = %ld\n", stats.writes);
+        output_printf(&output, "Dirty Page Evictions = %ld\n", stats.dirty_evictions);
+    }
+    if (vm->has_writeback && vm->writeback.queued > 0) {
+        WriteBack *wb = &vm->writeback;
+        output_printf(&output, "Pages Written Back = %ld (%ld queued, %ld coalesced)\n",
+                      wb->pages_written, wb->queued, wb->coalesced);
+        output_printf(&output, "Write-Back I/O Calls = %ld\n", wb->write_calls);
+        output_printf(&output, "Bytes Written Back = %ld\n", wb->bytes_written);
+        if (wb->async) {
+            output_printf(&output, "Write-Back Stalls = %ld\n", wb->stalls);
+        }
+        if (wb->error) {
+            fprintf(stderr, "Error: Some write-backs to %s failed\n", store_path);
+        }
+    }
+    if (vm->has_prefetch) {
+        Prefetcher *pf = &vm->prefetcher;
+        output_printf(&output, "Prefetches Issued = %ld\n", pf->issued);
+        output_printf(&output, "Prefetch Accuracy = %.3f\n",
+                      pf->issued > 0 ? (double)pf->used / pf->issued : 0.0);
+        output_printf(&output, "Prefetch Coverage = %.3f\n",
+                      stats.page_faults > 0 ? (double)pf->used / stats.page_faults : 0.0);
+        output_printf(&output, "Demand Faults Avoided = %ld (%ld waited on an unfinished prefetch)\n",
+                      pf->used, pf->late);
+    }
+    if (vm->has_huge) {
+        output_printf(&output, "Huge Page Promotions = %ld (%ld failed)\n", stats.huge_promotions,
+                      stats.failed_promotions);
+        output_printf(&output, "Huge Page Splits = %ld\n", stats.huge_demotions);
+        output_printf(&output, "Pages Loaded by Promotion = %ld\n", stats.promotion_loads);
+        output_printf(&output, "Huge TLB Hits = %ld\n", stats.huge_tlb_hits);
+        output_printf(&output, "Mean TLB Reach = %.0f bytes (%.0f bytes had each entry been a base page)\n",
+                      stats.tlb_reach, stats.tlb_base_reach);
+    }
+    if (vm->inverted) {
+        output_printf(&output, "Inverted Page Table = %zu bytes\n", stats.page_table_bytes);
+    } else if (stats.walk_levels > 1) {
+        output_printf(&output, "Page Table Levels = %d\n", stats.walk_levels);
+        output_printf(&output, "Page Tables Allocated = %ld (%zu bytes)\n", stats.page_tables,
+                      stats.page_table_bytes);
+    }
+    if (addresses_file.has_asids) {
+        for (int i = 0; i < vm->process_count; i++) {
+            VmmProcess *process = &vm->processes[i];
+            if (process->references > 0) {
+                output_printf(&output, "Process %d: References = %ld, Page Faults = %ld "
+                              "(rate %.3f), Resident Frames = %d\n", i, process->references,
+                              process->page_faults, (double)process->page_faults / process->references,
+                              process->resident);
+            }
+        }
+    }
+    output_flush(&output);
     
     // Cleanup
-    free(physical_memory);
-    free(frame_last_used);
-    fclose(addresses_file);
-    fclose(backing_store);
+    vmm_destroy(vm);
+    free(next_use);
+    trace_close(&addresses_file);
+    backing_store_close(&backing_store);
     
     return 0;
-}
\ No newline at end of file
+}
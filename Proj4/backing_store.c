@@ -0,0 +1,143 @@
+/**
+ * Project 4 - Backing store access
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * In mmap mode a page fault is a single memcpy from the mapping into the
+ * frame, instead of an fseek + fread pair into a stack buffer followed by a
+ * second byte-by-byte copy into physical memory.
+ *
+ * The default mode uses pread/pwrite rather than stdio, so there is no
+ * stdio buffer to go stale when a writer thread writes pages back while the
+ * simulator reads others.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "backing_store.h"
+
+#define MAX_IOVECS 64          // Pages per pwritev call
+
+int backing_store_open(BackingStore *store, const char *path, int page_size, bool use_mmap,
+                       bool writable) {
+    store->map = NULL;
+    store->map_size = 0;
+    store->size = 0;
+    store->page_size = page_size;
+    store->writable = writable;
+
+    store->fd = writable ? open(path, O_RDWR | O_CREAT, 0644) : open(path, O_RDONLY);
+    if (store->fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(store->fd, &st) != 0) {
+        backing_store_close(store);
+        return -1;
+    }
+    store->size = (size_t)st.st_size;
+    if (!use_mmap) {
+        return 0;
+    }
+    if (st.st_size == 0) {
+        backing_store_close(store);
+        return -1;
+    }
+
+    // Writable stores share the mapping with the file so writes land in it
+    void *map = mmap(NULL, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                     writable ? MAP_SHARED : MAP_PRIVATE, store->fd, 0);
+    if (map == MAP_FAILED) {
+        backing_store_close(store);
+        return -1;
+    }
+
+    // Faults jump around the file, so don't let the kernel read ahead
+    madvise(map, st.st_size, MADV_RANDOM);
+
+    store->map = (signed char *)map;
+    store->map_size = (size_t)st.st_size;
+    return 0;
+}
+
+void backing_store_read_page(BackingStore *store, int64_t page_number, signed char *dest) {
+    uint64_t start = (uint64_t)page_number * store->page_size;
+
+    if (store->map != NULL && start + store->page_size <= store->map_size) {
+        // One bulk copy straight from the mapping into the frame
+        memcpy(dest, store->map + start, store->page_size);
+        return;
+    }
+
+    // Pages past the end of a read-only file (wide address spaces) read as
+    // zeros; a writable file may have grown, so it is always asked
+    if (!store->writable && start >= store->size) {
+        memset(dest, 0, store->page_size);
+        return;
+    }
+
+    // Read the page directly into the frame
+    ssize_t got = pread(store->fd, dest, store->page_size, (off_t)start);
+    if (got < 0) {
+        got = 0;
+    }
+    if (got < store->page_size) {
+        memset(dest + got, 0, store->page_size - got);
+    }
+}
+
+int backing_store_write_pages(BackingStore *store, int64_t first_page,
+                              const signed char *const *pages, int count) {
+    if (!store->writable) {
+        return -1;
+    }
+
+    int done = 0;
+    uint64_t start = (uint64_t)first_page * store->page_size;
+
+    // Pages inside the shared mapping are plain copies
+    while (done < count && store->map != NULL &&
+           start + (uint64_t)(done + 1) * store->page_size <= store->map_size) {
+        memcpy(store->map + start + (uint64_t)done * store->page_size, pages[done], store->page_size);
+        done++;
+    }
+
+    // The rest go out as vectored writes
+    while (done < count) {
+        struct iovec iov[MAX_IOVECS];
+        int n = count - done < MAX_IOVECS ? count - done : MAX_IOVECS;
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = (void *)pages[done + i];
+            iov[i].iov_len = store->page_size;
+        }
+        off_t offset = (off_t)(start + (uint64_t)done * store->page_size);
+        ssize_t wrote = pwritev(store->fd, iov, n, offset);
+        if (wrote < 0 && errno == EINTR) {
+            continue;
+        }
+        if (wrote < 0 || wrote % store->page_size != 0) {
+            return -1;
+        }
+        done += (int)(wrote / store->page_size);
+    }
+    return 0;
+}
+
+void backing_store_close(BackingStore *store) {
+    if (store->map != NULL) {
+        munmap(store->map, store->map_size);
+        store->map = NULL;
+    }
+    if (store->fd >= 0) {
+        close(store->fd);
+        store->fd = -1;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * Project 4 - Backing store access
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Pages are read from BACKING_STORE.bin either with pread (default) or, in
+ * mmap mode, copied straight out of a mapping of the file.
+ *
+ * The store is read-only unless opened writable (creating the file if
+ * needed), in which case pages can be written back, a run of consecutive
+ * pages in one call. Writes past the end of the file extend it; reads past
+ * the end return zeros.
+ */
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Backing store handle
+typedef struct {
+    int fd;                     // File descriptor (always open)
+    signed char *map;           // Mapping of the file (mmap mode)
+    size_t map_size;            // Size of the mapping in bytes
+    size_t size;                // Size of the file in bytes when opened
+    int page_size;              // Size of each page (in bytes)
+    bool writable;              // Opened read-write
+} BackingStore;
+
+// Open the backing store; returns 0 on success, -1 on error
+int backing_store_open(BackingStore *store, const char *path, int page_size, bool use_mmap,
+                       bool writable);
+
+// Copy one page from the backing store into dest (page_size bytes)
+void backing_store_read_page(BackingStore *store, int64_t page_number, signed char *dest);
+
+// Write `count` consecutive pages starting at first_page, taking page i from
+// pages[i]; returns 0 on success, -1 on error (or if the store is read-only)
+int backing_store_write_pages(BackingStore *store, int64_t first_page,
+                              const signed char *const *pages, int count);
+
+// Close the backing store and release the mapping
+void backing_store_close(BackingStore *store);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ * Project 4 - Concurrent virtual memory manager core
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Seqlock protocol for a frame (Boehm's fence formulation):
+ *   replacer: sequence = s + 1; release fence; update frame_page and the
+ *             bytes; sequence = s + 2 (release)
+ *   reader:   s = sequence (acquire); check frame_page and read the byte;
+ *             acquire fence; valid if s is even and sequence is still s
+ * All frame bytes are accessed with relaxed atomics, so a reader racing a
+ * replacement sees a torn page at worst and then discards it.
+ */
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cvmm.h"
+
+// Page table entry encoding
+#define PTE_INVALID 0u         // Not resident
+#define PTE_LOADING 1u         // A thread is reading the page in
+#define PTE_FRAME_BASE 2u      // Resident in frame (entry - PTE_FRAME_BASE)
+
+Cvmm *cvmm_create(const VmmConfig *config, BackingStore *store) {
+    int page_bits = 0;
+    while (page_bits < 30 && (1 << page_bits) < config->page_size) {
+        page_bits++;
+    }
+    int vpn_bits = config->address_bits - page_bits;
+    if (config->page_size < 16 || (1 << page_bits) != config->page_size ||
+        config->address_bits < 16 || vpn_bits < 1 || vpn_bits > CVMM_MAX_PAGE_BITS) {
+        fprintf(stderr, "Error: Unsupported geometry (%d-bit addresses, %d-byte pages)\n",
+                config->address_bits, config->page_size);
+        fprintf(stderr, "       pages must be a power of two of at least 16 bytes and page\n"
+                        "       numbers 1-%d bits\n", CVMM_MAX_PAGE_BITS);
+        return NULL;
+    }
+    long page_count = 1L << vpn_bits;
+    if (config->frame_count <= 0 || config->frame_count > page_count) {
+        fprintf(stderr, "Error: Frame count must be between 1 and %ld\n", page_count);
+        return NULL;
+    }
+    int tlb_policy = tlb_policy_from_name(config->tlb_policy);
+    Tlb probe;
+    if (tlb_policy == -1 || tlb_init(&probe, config->tlb_size, config->tlb_ways, (TlbPolicy)tlb_policy) != 0) {
+        fprintf(stderr, "Error: Unsupported TLB (size %d, ways %d, policy %s)\n",
+                config->tlb_size, config->tlb_ways, config->tlb_policy);
+        return NULL;
+    }
+    tlb_destroy(&probe);
+
+    Cvmm *vm = calloc(1, sizeof(Cvmm));
+    if (vm == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return NULL;
+    }
+    vm->frame_count = config->frame_count;
+    vm->page_size = config->page_size;
+    vm->page_bits = page_bits;
+    vm->address_mask = ((uint64_t)1 << config->address_bits) - 1;
+    vm->tlb_size = config->tlb_size;
+    vm->tlb_ways = config->tlb_ways;
+    vm->tlb_policy = (TlbPolicy)tlb_policy;
+    vm->store = store;
+
+    // calloc gives all-invalid entries, even sequences and clear flags
+    vm->entries = calloc(page_count, sizeof(*vm->entries));
+    vm->frame_page = malloc(vm->frame_count * sizeof(*vm->frame_page));
+    vm->sequence = calloc(vm->frame_count, sizeof(*vm->sequence));
+    vm->referenced = calloc(vm->frame_count, sizeof(*vm->referenced));
+    vm->busy = calloc(vm->frame_count, sizeof(*vm->busy));
+    if (store != NULL) {
+        vm->memory = calloc((size_t)vm->frame_count * vm->page_size, 1);
+    }
+    if (vm->entries == NULL || vm->frame_page == NULL || vm->sequence == NULL ||
+        vm->referenced == NULL || vm->busy == NULL || (store != NULL && vm->memory == NULL)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        cvmm_destroy(vm);
+        return NULL;
+    }
+    for (int i = 0; i < vm->frame_count; i++) {
+        atomic_init(&vm->frame_page[i], -1);
+    }
+    atomic_init(&vm->next_free, 0);
+    atomic_init(&vm->hand, 0);
+    return vm;
+}
+
+void cvmm_destroy(Cvmm *vm) {
+    if (vm == NULL) {
+        return;
+    }
+    free((void *)vm->entries);
+    free((void *)vm->frame_page);
+    free((void *)vm->sequence);
+    free((void *)vm->referenced);
+    free((void *)vm->busy);
+    free((void *)vm->memory);
+    free(vm);
+}
+
+int cvmm_thread_init(CvmmThread *thread, Cvmm *vm) {
+    memset(thread, 0, sizeof(*thread));
+    thread->vm = vm;
+    if (tlb_init(&thread->tlb, vm->tlb_size, vm->tlb_ways, vm->tlb_policy) != 0) {
+        return -1;
+    }
+    thread->staging = malloc(vm->page_size);
+    if (thread->staging == NULL) {
+        tlb_destroy(&thread->tlb);
+        return -1;
+    }
+    return 0;
+}
+
+void cvmm_thread_destroy(CvmmThread *thread) {
+    tlb_destroy(&thread->tlb);
+    free(thread->staging);
+    thread->staging = NULL;
+}
+
+// Claim a frame: a never-used one, or the clock's next unreferenced one
+static int claim_frame(Cvmm *vm) {
+    int frame = atomic_fetch_add_explicit(&vm->next_free, 1, memory_order_relaxed);
+    if (frame < vm->frame_count) {
+        atomic_store_explicit(&vm->busy[frame], true, memory_order_relaxed);
+        return frame;
+    }
+    while (1) {
+        frame = (int)(atomic_fetch_add_explicit(&vm->hand, 1, memory_order_relaxed) % vm->frame_count);
+        if (atomic_exchange_explicit(&vm->referenced[frame], false, memory_order_relaxed)) {
+            continue;   // Second chance
+        }
+        bool idle = false;
+        if (atomic_compare_exchange_strong_explicit(&vm->busy[frame], &idle, true,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            return frame;
+        }
+    }
+}
+
+// Read a page whose entry this thread has set to loading into a frame,
+// evicting the frame's old page; returns the frame
+static int load_page(CvmmThread *thread, int64_t page_number) {
+    Cvmm *vm = thread->vm;
+    int frame = claim_frame(vm);
+
+    // Fill the staging buffer before taking the frame offline
+    if (vm->memory != NULL) {
+        backing_store_read_page(vm->store, page_number, thread->staging);
+    }
+
+    uint32_t sequence = atomic_load_explicit(&vm->sequence[frame], memory_order_relaxed);
+    atomic_store_explicit(&vm->sequence[frame], sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    int64_t old_page = atomic_load_explicit(&vm->frame_page[frame], memory_order_relaxed);
+    if (old_page != -1) {
+        atomic_store_explicit(&vm->entries[old_page], PTE_INVALID, memory_order_release);
+    }
+    atomic_store_explicit(&vm->frame_page[frame], page_number, memory_order_relaxed);
+    if (vm->memory != NULL) {
+        _Atomic signed char *bytes = &vm->memory[(size_t)frame * vm->page_size];
+        for (int i = 0; i < vm->page_size; i++) {
+            atomic_store_explicit(&bytes[i], thread->staging[i], memory_order_relaxed);
+        }
+    }
+
+    atomic_store_explicit(&vm->sequence[frame], sequence + 2, memory_order_release);
+    atomic_store_explicit(&vm->entries[page_number], PTE_FRAME_BASE + (uint32_t)frame,
+                          memory_order_release);
+    atomic_store_explicit(&vm->referenced[frame], true, memory_order_relaxed);
+    atomic_store_explicit(&vm->busy[frame], false, memory_order_release);
+    return frame;
+}
+
+uint64_t cvmm_access(CvmmThread *thread, uint64_t logical_address, signed char *value) {
+    Cvmm *vm = thread->vm;
+    int64_t page_number = (int64_t)((logical_address & vm->address_mask) >> vm->page_bits);
+    int offset = (int)(logical_address & (uint64_t)(vm->page_size - 1));
+    bool waited = false;
+    thread->references++;
+
+    while (1) {
+        int frame = tlb_lookup(&thread->tlb, page_number);
+        bool from_tlb = frame != -1;
+        if (!from_tlb) {
+            uint32_t entry = atomic_load_explicit(&vm->entries[page_number], memory_order_acquire);
+            if (entry == PTE_LOADING) {
+                // Another thread is reading this page in: wait for it
+                if (!waited) {
+                    thread->coalesced++;
+                    waited = true;
+                }
+                sched_yield();
+                continue;
+            }
+            if (entry == PTE_INVALID) {
+                if (!atomic_compare_exchange_strong_explicit(&vm->entries[page_number], &entry, PTE_LOADING,
+                                                             memory_order_acquire, memory_order_relaxed)) {
+                    continue;   // Someone else got there first
+                }
+                thread->page_faults++;
+                frame = load_page(thread, page_number);
+            } else {
+                frame = (int)(entry - PTE_FRAME_BASE);
+            }
+        }
+
+        // Seqlock-validated read of the byte
+        uint32_t sequence = atomic_load_explicit(&vm->sequence[frame], memory_order_acquire);
+        if ((sequence & 1) == 0 &&
+            atomic_load_explicit(&vm->frame_page[frame], memory_order_relaxed) == page_number) {
+            uint64_t physical_address = (uint64_t)frame * vm->page_size + offset;
+            signed char byte = vm->memory != NULL
+                ? atomic_load_explicit(&vm->memory[physical_address], memory_order_relaxed) : 0;
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&vm->sequence[frame], memory_order_relaxed) == sequence) {
+                if (from_tlb) {
+                    thread->tlb_hits++;
+                } else {
+                    tlb_insert(&thread->tlb, page_number, frame);
+                }
+                // Only write the shared bit when it changes
+                if (!atomic_load_explicit(&vm->referenced[frame], memory_order_relaxed)) {
+                    atomic_store_explicit(&vm->referenced[frame], true, memory_order_relaxed);
+                }
+                *value = byte;
+                return physical_address;
+            }
+        }
+
+        // The frame was replaced under us: drop the stale translation and retry
+        thread->stale++;
+        if (from_tlb) {
+            tlb_invalidate(&thread->tlb, page_number);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * Project 4 - Concurrent virtual memory manager core
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * A thread-safe counterpart of the Vmm (see vmm.h) for replaying traces on
+ * many threads at once against one shared page table and frame pool.
+ * Reads only; no dirty tracking or write-back.
+ *
+ * - Each thread has its own TLB (a CvmmThread), so TLB hits touch no
+ *   shared state except the frame's sequence counter. TLBs are never shot
+ *   down; a hit on a frame that has since been replaced fails validation
+ *   and is dropped.
+ * - Page table entries are single atomic words (invalid, loading, or a
+ *   frame number) read without locks.
+ * - Each frame has a seqlock: it is odd while the frame is being replaced,
+ *   and a translation only succeeds if the frame held the page and the
+ *   counter did not change while the byte was read.
+ * - Frames are replaced by a concurrent clock: an atomic hand, atomic
+ *   reference bits, and a per-frame busy flag so two faults never pick
+ *   the same victim.
+ * - Faults coalesce: the first thread to fault on a page swings its entry
+ *   from invalid to loading and reads it; others faulting on the same
+ *   page wait for the entry to become valid instead of reading it again.
+ *
+ * The page table is a flat array of 2^(address bits - page bits) entries,
+ * so the page number may have at most CVMM_MAX_PAGE_BITS bits.
+ */
+#ifndef CVMM_H
+#define CVMM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "backing_store.h"
+#include "tlb.h"
+#include "vmm.h"
+
+#define CVMM_MAX_PAGE_BITS 24
+
+// Shared state
+typedef struct {
+    int frame_count;
+    int page_size;
+    int page_bits;
+    uint64_t address_mask;
+    int tlb_size;                // Per-thread TLB geometry
+    int tlb_ways;
+    TlbPolicy tlb_policy;
+    BackingStore *store;         // NULL in statistics-only mode
+    _Atomic uint32_t *entries;   // Page table (see cvmm.c for the encoding)
+    _Atomic int64_t *frame_page; // Page held by each frame, or -1
+    _Atomic uint32_t *sequence;  // Seqlock of each frame
+    atomic_bool *referenced;     // Clock reference bits
+    atomic_bool *busy;           // Frame is being replaced
+    atomic_int next_free;        // Next never-used frame
+    atomic_ulong hand;           // Clock hand (taken modulo frame_count)
+    _Atomic signed char *memory; // Physical memory (NULL in statistics-only mode)
+} Cvmm;
+
+// Per-thread state and statistics
+typedef struct {
+    Cvmm *vm;
+    Tlb tlb;
+    signed char *staging;        // Page buffer for backing store reads
+    long references;
+    long tlb_hits;
+    long page_faults;            // Pages this thread read in
+    long coalesced;              // Faults that waited for another thread's read
+    long stale;                  // Translations retried because the frame was replaced
+} CvmmThread;
+
+// Create the shared state from a configuration's geometry, frame count and
+// L1 TLB settings (the replacement policy is always the concurrent clock);
+// reports bad parameters on stderr and returns NULL
+Cvmm *cvmm_create(const VmmConfig *config, BackingStore *store);
+
+// Free the shared state (after every thread has been destroyed)
+void cvmm_destroy(Cvmm *vm);
+
+// Set up a thread's TLB and buffers; returns 0 on success
+int cvmm_thread_init(CvmmThread *thread, Cvmm *vm);
+
+// Release a thread's TLB and buffers
+void cvmm_thread_destroy(CvmmThread *thread);
+
+// Translate one logical address; returns the physical address and stores
+// the byte found there in *value. Safe to call from many threads, each
+// with its own CvmmThread.
+uint64_t cvmm_access(CvmmThread *thread, uint64_t logical_address, signed char *value);
+
+#endif
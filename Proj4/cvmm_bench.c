@@ -0,0 +1,174 @@
+/**
+ * Project 4 - Concurrent VMM scalability benchmark
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ * Usage: ./cvmm_bench [trace_file] [max_threads] [frame_count]
+ * Build: gcc -O2 -pthread -o cvmm_bench cvmm_bench.c cvmm.c tlb.c backing_store.c trace.c
+ *
+ * Replays a trace (addresses.txt by default) through one shared concurrent
+ * VMM (see cvmm.h) on 1, 2, 4, ... max_threads threads. Each thread makes
+ * the same number of references, starting at its own offset into the trace
+ * and wrapping around, and checks every byte it reads against the backing
+ * store. Reports throughput, speedup over one thread, and how many faults
+ * were coalesced or translations retried.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cvmm.h"
+#include "trace.h"
+
+#define REFS_PER_THREAD 2000000
+
+typedef struct {
+    CvmmThread context;
+    const uint64_t *addresses;
+    long count;
+    long start;
+    const BackingStore *store;
+    long mismatches;
+} Worker;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void *worker_main(void *arg) {
+    Worker *worker = arg;
+    long i = worker->start;
+    signed char value;
+    for (long n = 0; n < REFS_PER_THREAD; n++) {
+        uint64_t address = worker->addresses[i] & worker->context.vm->address_mask;
+        cvmm_access(&worker->context, address, &value);
+        signed char expected = address < worker->store->map_size ? worker->store->map[address] : 0;
+        if (value != expected) {
+            worker->mismatches++;
+        }
+        if (++i == worker->count) {
+            i = 0;
+        }
+    }
+    return NULL;
+}
+
+// Run one round on `threads` threads; returns references per second
+static double run(const VmmConfig *config, BackingStore *store, const uint64_t *addresses, long count,
+                  int threads, CvmmThread *totals, long *mismatches) {
+    Cvmm *vm = cvmm_create(config, store);
+    Worker *workers = calloc(threads, sizeof(Worker));
+    pthread_t *ids = calloc(threads, sizeof(pthread_t));
+    if (vm == NULL || workers == NULL || ids == NULL) {
+        cvmm_destroy(vm);
+        free(workers);
+        free(ids);
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        if (cvmm_thread_init(&workers[t].context, vm) != 0) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        workers[t].addresses = addresses;
+        workers[t].count = count;
+        workers[t].start = (long)((double)count * t / threads);
+        workers[t].store = store;
+    }
+
+    double start = now_ns();
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&ids[t], NULL, worker_main, &workers[t]) != 0) {
+            fprintf(stderr, "Error: Could not start thread %d\n", t);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    double seconds = (now_ns() - start) / 1e9;
+
+    memset(totals, 0, sizeof(*totals));
+    *mismatches = 0;
+    for (int t = 0; t < threads; t++) {
+        totals->references += workers[t].context.references;
+        totals->tlb_hits += workers[t].context.tlb_hits;
+        totals->page_faults += workers[t].context.page_faults;
+        totals->coalesced += workers[t].context.coalesced;
+        totals->stale += workers[t].context.stale;
+        *mismatches += workers[t].mismatches;
+        cvmm_thread_destroy(&workers[t].context);
+    }
+    cvmm_destroy(vm);
+    free(workers);
+    free(ids);
+    return totals->references / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : "addresses.txt";
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = argc > 2 ? atoi(argv[2]) : (online > 1 ? (int)online : 4);
+    // Only the fields the concurrent core reads
+    VmmConfig config;
+    memset(&config, 0, sizeof(config));
+    config.address_bits = ADDRESS_BITS;
+    config.page_size = PAGE_SIZE;
+    config.tlb_size = TLB_SIZE;
+    config.tlb_ways = 0;
+    config.tlb_policy = "fifo";
+    config.frame_count = argc > 3 ? atoi(argv[3]) : 128;
+    if (max_threads <= 0 || config.frame_count <= 0) {
+        fprintf(stderr, "Usage: %s [trace_file] [max_threads] [frame_count]\n", argv[0]);
+        return -1;
+    }
+
+    long count;
+    uint64_t *addresses = trace_load(path, &count, NULL);
+    if (addresses == NULL || count == 0) {
+        fprintf(stderr, "Error: Could not read addresses from %s\n", path);
+        free(addresses);
+        return -1;
+    }
+    BackingStore store;
+    if (backing_store_open(&store, "BACKING_STORE.bin", config.page_size, true, false) != 0) {
+        fprintf(stderr, "Error: Could not open BACKING_STORE.bin\n");
+        free(addresses);
+        return -1;
+    }
+
+    printf("%d references per thread, %d frames, %d-entry TLB per thread\n",
+           REFS_PER_THREAD, config.frame_count, config.tlb_size);
+    printf("threads  Mrefs/s  speedup  TLB hit  faults  coalesced  retries\n");
+    double single = 0;
+    int status = 0;
+    for (int threads = 1; threads <= max_threads; threads = threads * 2 > max_threads && threads < max_threads
+                                                               ? max_threads : threads * 2) {
+        CvmmThread totals;
+        long mismatches;
+        double rate = run(&config, &store, addresses, count, threads, &totals, &mismatches);
+        if (rate < 0) {
+            status = -1;
+            break;
+        }
+        if (threads == 1) {
+            single = rate;
+        }
+        printf("%7d  %7.2f  %6.2fx  %6.2f%%  %6ld  %9ld  %7ld\n", threads, rate / 1e6, rate / single,
+               100.0 * totals.tlb_hits / totals.references, totals.page_faults, totals.coalesced,
+               totals.stale);
+        if (mismatches != 0) {
+            fprintf(stderr, "Error: %ld values differ from the backing store\n", mismatches);
+            status = -1;
+            break;
+        }
+    }
+
+    backing_store_close(&store);
+    free(addresses);
+    return status;
+}
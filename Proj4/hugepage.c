@@ -0,0 +1,152 @@
+/**
+ * Project 4 - Huge pages
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "hugepage.h"
+
+int hugepage_init(HugePages *huge, const int *factors, int count, int promote_percent) {
+    memset(huge, 0, sizeof(*huge));
+    if (count < 0 || count > MAX_HUGE_SIZES || promote_percent < 1 || promote_percent > 100) {
+        return -1;
+    }
+    huge->count = count;
+    huge->promote_percent = promote_percent;
+
+    // Sizes sorted ascending (insertion sort of at most MAX_HUGE_SIZES)
+    for (int i = 0; i < count; i++) {
+        int shift = 1;
+        while (shift < 30 && (1 << shift) < factors[i]) {
+            shift++;
+        }
+        if (factors[i] < 2 || (1 << shift) != factors[i]) {
+            return -1;
+        }
+        int c = i + 1;
+        while (c > 1 && huge->shifts[c - 1] > shift) {
+            huge->shifts[c] = huge->shifts[c - 1];
+            c--;
+        }
+        if (c > 1 && huge->shifts[c - 1] == shift) {
+            return -1;
+        }
+        huge->shifts[c] = shift;
+    }
+
+    for (int c = 1; c <= count; c++) {
+        if (pagemap_init(&huge->resident[c], 256) != 0 || pagemap_init(&huge->promoted[c], 64) != 0) {
+            hugepage_destroy(huge);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void hugepage_destroy(HugePages *huge) {
+    for (int c = 1; c <= MAX_HUGE_SIZES; c++) {
+        pagemap_destroy(&huge->resident[c]);
+        pagemap_destroy(&huge->promoted[c]);
+    }
+}
+
+int hugepage_class(const HugePages *huge, int64_t page_number) {
+    for (int c = huge->count; c >= 1; c--) {
+        if (pagemap_get(&huge->promoted[c], page_number >> huge->shifts[c], 0) != 0) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+int hugepage_add(HugePages *huge, int64_t page_number) {
+    int candidate = 0;
+    for (int c = 1; c <= huge->count; c++) {
+        int64_t region = page_number >> huge->shifts[c];
+        long resident = pagemap_get(&huge->resident[c], region, 0) + 1;
+        if (pagemap_put(&huge->resident[c], region, resident) != 0) {
+            return -1;
+        }
+        if (resident * 100 >= (long)huge->promote_percent << huge->shifts[c]) {
+            candidate = c;
+        }
+    }
+
+    // Only promote to a size larger than the page is already mapped with
+    return candidate > hugepage_class(huge, page_number) ? candidate : 0;
+}
+
+int hugepage_remove(HugePages *huge, int64_t page_number) {
+    int split = hugepage_class(huge, page_number);
+    if (split > 0) {
+        pagemap_remove(&huge->promoted[split], page_number >> huge->shifts[split]);
+        huge->demotions++;
+    }
+    for (int c = 1; c <= huge->count; c++) {
+        int64_t region = page_number >> huge->shifts[c];
+        long resident = pagemap_get(&huge->resident[c], region, 0) - 1;
+        if (resident > 0) {
+            if (pagemap_put(&huge->resident[c], region, resident) != 0) {
+                return -1;
+            }
+        } else {
+            pagemap_remove(&huge->resident[c], region);
+        }
+    }
+    return split;
+}
+
+bool hugepage_full(const HugePages *huge, int size, int64_t page_number) {
+    return pagemap_get(&huge->resident[size], page_number >> huge->shifts[size], 0) ==
+           1L << huge->shifts[size];
+}
+
+int hugepage_promote(HugePages *huge, int size, int64_t page_number) {
+    int64_t region = page_number >> huge->shifts[size];
+    if (pagemap_put(&huge->promoted[size], region, 1) != 0) {
+        return -1;
+    }
+
+    // Absorb smaller huge pages inside the region
+    for (int c = 1; c < size; c++) {
+        int64_t first = region << (huge->shifts[size] - huge->shifts[c]);
+        int64_t last = first + (1L << (huge->shifts[size] - huge->shifts[c]));
+        for (int64_t inner = first; inner < last; inner++) {
+            pagemap_remove(&huge->promoted[c], inner);
+        }
+    }
+    huge->promotions++;
+    return 0;
+}
+
+// Add the bytes mapped by one TLB's valid entries (and the entry count),
+// skipping keys also held by `other` (NULL = none)
+static void tlb_reach(const HugePages *huge, const Tlb *tlb, const Tlb *other, double *bytes,
+                      long *entries) {
+    for (int i = 0; i < tlb->sets * tlb->stride; i++) {
+        int64_t key = tlb->pages[i];
+        if (key != TLB_INVALID && (other == NULL || tlb_find(other, key) < 0)) {
+            *bytes += (double)(1L << huge->shifts[key >> HUGE_TAG_SHIFT]);
+            (*entries)++;
+        }
+    }
+}
+
+double hugepage_reach(const HugePages *huge, const TlbHierarchy *tlbs, int page_size,
+                      double *base_bytes) {
+    double pages = 0;
+    long entries = 0;
+    if (tlbs->has_l2) {
+        // An inclusive L2 already holds everything in L1
+        tlb_reach(huge, &tlbs->l2, NULL, &pages, &entries);
+        if (tlbs->inclusion != TLB_INCLUSIVE) {
+            tlb_reach(huge, &tlbs->l1, &tlbs->l2, &pages, &entries);
+        }
+    } else {
+        tlb_reach(huge, &tlbs->l1, NULL, &pages, &entries);
+    }
+    *base_bytes = (double)entries * page_size;
+    return pages * page_size;
+}
@@ -0,0 +1,96 @@
+/**
+ * Project 4 - Huge pages
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Besides base pages, up to MAX_HUGE_SIZES huge page sizes can be mapped,
+ * each a power-of-two number of base pages (e.g. 16x and 512x). Size
+ * class 0 is the base page; classes 1..count are the huge sizes in
+ * ascending order. A region is the aligned run of base pages one huge
+ * page of a class covers.
+ *
+ * Promotion works like khugepaged: once at least promote_percent of a
+ * region's base pages are resident, its missing pages are loaded and the
+ * region is mapped as one huge page (the largest class that qualifies),
+ * absorbing any smaller huge pages inside it. Evicting any base page of a
+ * huge page splits it back into base pages, so replacement policies keep
+ * working frame by frame.
+ *
+ * The TLB holds entries of every size: a huge page's entry is keyed by
+ * its class above HUGE_TAG_SHIFT and its region number below, so one
+ * lookup probes each size class that is in use. Frames of a huge page are
+ * not physically contiguous in the simulation; the entry only records that
+ * the region is mapped, and the frame of the base page is read from the
+ * page table without charging a walk.
+ */
+#ifndef HUGEPAGE_H
+#define HUGEPAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pagemap.h"
+#include "tlb.h"
+
+#define MAX_HUGE_SIZES 3       // Huge page sizes usable at once
+#define PROMOTE_PERCENT 50     // Default share of a region resident before promotion
+#define HUGE_TAG_SHIFT 60      // Size class bits of a huge TLB key
+#define MAX_HUGE_PAGE_BITS 44  // Widest page numbers (with ASIDs) below the tag
+#define HUGE_REACH_SAMPLE 64   // References between TLB reach samples
+
+// Huge page state
+typedef struct {
+    int count;                               // Huge page sizes
+    int shifts[MAX_HUGE_SIZES + 1];          // log2(base pages) per class; shifts[0] = 0
+    int promote_percent;
+    PageMap resident[MAX_HUGE_SIZES + 1];    // Region -> resident base pages (classes 1..count)
+    PageMap promoted[MAX_HUGE_SIZES + 1];    // Regions mapped as huge pages
+    long promotions;
+    long failed_promotions;                  // Regions that lost pages while being filled
+    long demotions;                          // Huge pages split by an eviction
+    long promotion_loads;                    // Base pages loaded to complete regions
+    long tlb_hits;                           // TLB hits on huge entries
+    double reach_sum;                        // Sum of sampled TLB reach (bytes)
+    double base_reach_sum;                   // Same samples counting each entry as a base page
+    long reach_samples;
+} HugePages;
+
+// Set up huge pages of the given sizes (base pages each, powers of two
+// above 1, any order); returns 0 on success, -1 for bad sizes or on
+// allocation failure
+int hugepage_init(HugePages *huge, const int *factors, int count, int promote_percent);
+
+// Release the maps
+void hugepage_destroy(HugePages *huge);
+
+// TLB key of a page's translation at a size class
+static inline int64_t hugepage_key(const HugePages *huge, int size, int64_t page_number) {
+    if (size == 0) {
+        return page_number;
+    }
+    return ((int64_t)size << HUGE_TAG_SHIFT) | (page_number >> huge->shifts[size]);
+}
+
+// Size class a resident page is mapped with (0 = base page)
+int hugepage_class(const HugePages *huge, int64_t page_number);
+
+// Count a page that became resident; returns the class its region should
+// now be promoted to (0 = none), or -1 on allocation failure
+int hugepage_add(HugePages *huge, int64_t page_number);
+
+// Count a page that was evicted; returns the class of the huge page it
+// split (0 = none), or -1 on allocation failure
+int hugepage_remove(HugePages *huge, int64_t page_number);
+
+// Whether every base page of a page's region at a class is resident
+bool hugepage_full(const HugePages *huge, int size, int64_t page_number);
+
+// Map a page's full region as a huge page of a class; returns 0 on success
+int hugepage_promote(HugePages *huge, int size, int64_t page_number);
+
+// Bytes of memory the TLBs currently map, counting a translation held in
+// both levels once; *base_bytes gets the same entries as base pages
+double hugepage_reach(const HugePages *huge, const TlbHierarchy *tlbs, int page_size,
+                      double *base_bytes);
+
+#endif
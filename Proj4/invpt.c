@@ -0,0 +1,77 @@
+/**
+ * Project 4 - Inverted page table
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "invpt.h"
+
+int invpt_init(InvertedPageTable *ipt, int frame_count) {
+    memset(ipt, 0, sizeof(*ipt));
+    size_t slots = 16;
+    while (slots < (size_t)frame_count * 2) {
+        slots *= 2;
+    }
+    ipt->frame_count = frame_count;
+    ipt->mask = slots - 1;
+    ipt->page_of_frame = malloc(frame_count * sizeof(int64_t));
+    ipt->dirty = calloc(frame_count, sizeof(bool));
+    ipt->anchors = malloc(slots * sizeof(int));
+    if (ipt->page_of_frame == NULL || ipt->dirty == NULL || ipt->anchors == NULL) {
+        invpt_destroy(ipt);
+        return -1;
+    }
+    ipt->bytes = frame_count * (sizeof(int64_t) + sizeof(bool)) + slots * sizeof(int);
+    for (int i = 0; i < frame_count; i++) {
+        ipt->page_of_frame[i] = -1;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        ipt->anchors[i] = -1;
+    }
+    return 0;
+}
+
+void invpt_destroy(InvertedPageTable *ipt) {
+    free(ipt->page_of_frame);
+    free(ipt->dirty);
+    free(ipt->anchors);
+    ipt->page_of_frame = NULL;
+    ipt->dirty = NULL;
+    ipt->anchors = NULL;
+    ipt->bytes = 0;
+}
+
+void invpt_map(InvertedPageTable *ipt, int64_t page_number, int frame_number) {
+    size_t i = invpt_slot(ipt, page_number);
+    while (ipt->anchors[i] != -1) {
+        i = (i + 1) & ipt->mask;
+    }
+    ipt->anchors[i] = frame_number;
+    ipt->page_of_frame[frame_number] = page_number;
+    ipt->dirty[frame_number] = false;
+}
+
+void invpt_unmap(InvertedPageTable *ipt, int frame_number) {
+    int64_t page_number = ipt->page_of_frame[frame_number];
+    if (page_number == -1) {
+        return;
+    }
+    size_t i = invpt_slot(ipt, page_number);
+    while (ipt->anchors[i] != frame_number) {
+        i = (i + 1) & ipt->mask;
+    }
+
+    // Backward-shift deletion keeps every probe run unbroken (no tombstones)
+    size_t hole = i;
+    for (size_t j = (hole + 1) & ipt->mask; ipt->anchors[j] != -1; j = (j + 1) & ipt->mask) {
+        size_t home = invpt_slot(ipt, ipt->page_of_frame[ipt->anchors[j]]);
+        if (((j - home) & ipt->mask) >= ((j - hole) & ipt->mask)) {
+            ipt->anchors[hole] = ipt->anchors[j];
+            hole = j;
+        }
+    }
+    ipt->anchors[hole] = -1;
+    ipt->page_of_frame[frame_number] = -1;
+}
@@ -0,0 +1,61 @@
+/**
+ * Project 4 - Inverted page table
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * One entry per physical frame records the page it holds, so the table is
+ * sized by frame_count rather than by the virtual address space. Finding
+ * the frame of a page goes through a hash anchor table: an open-addressing
+ * (linear probing) array of frame numbers keyed by the page each frame
+ * holds, at most half full. The frame-to-page direction is a plain array
+ * index, so eviction needs no search.
+ */
+#ifndef INVPT_H
+#define INVPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Inverted page table state
+typedef struct {
+    int frame_count;
+    int64_t *page_of_frame;  // Page held by each frame, or -1
+    bool *dirty;             // Frame written since its page was loaded
+    int *anchors;            // Hash slots holding frame numbers, or -1
+    size_t mask;             // Number of hash slots - 1 (power of two)
+    size_t bytes;            // Bytes allocated for both arrays
+} InvertedPageTable;
+
+// Hash slot where the search for a page starts (Fibonacci hashing)
+static inline size_t invpt_slot(const InvertedPageTable *ipt, int64_t page_number) {
+    return (size_t)(((uint64_t)page_number * 0x9E3779B97F4A7C15ULL) >> 32) & ipt->mask;
+}
+
+// Set up an empty table for frame_count frames; returns 0 on success
+int invpt_init(InvertedPageTable *ipt, int frame_count);
+
+// Release the table
+void invpt_destroy(InvertedPageTable *ipt);
+
+// Record that a (currently unmapped) page now lives in a free frame (clean)
+void invpt_map(InvertedPageTable *ipt, int64_t page_number, int frame_number);
+
+// Forget whatever page a frame holds
+void invpt_unmap(InvertedPageTable *ipt, int frame_number);
+
+// Frame holding a page, or -1 if the page is not resident
+static inline int invpt_lookup(const InvertedPageTable *ipt, int64_t page_number) {
+    for (size_t i = invpt_slot(ipt, page_number); ; i = (i + 1) & ipt->mask) {
+        int frame = ipt->anchors[i];
+        if (frame == -1) {
+            return -1;
+        }
+        if (ipt->page_of_frame[frame] == page_number) {
+            return frame;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * Project 4 - Simulated-time cost model
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include "latency.h"
+
+void cost_model_init(CostModel *cost) {
+    cost->l1_tlb_ns = 0.5;
+    cost->l2_tlb_ns = 3.5;
+    cost->walk_ns = 20.0;
+    cost->memory_ns = 80.0;
+    cost->fault_us = 100.0;
+}
+
+// Histogram bucket of a latency in units of 1/100 ns
+static int bucket_of(uint64_t units) {
+    if (units < (1u << LATENCY_SUB_BITS)) {
+        return (int)units;
+    }
+    int exponent = 63 - __builtin_clzll(units);
+    int shift = exponent - LATENCY_SUB_BITS;
+    int sub = (int)((units >> shift) & ((1u << LATENCY_SUB_BITS) - 1));
+    return ((shift + 1) << LATENCY_SUB_BITS) + sub;
+}
+
+void latency_record(LatencyStats *stats, double ns) {
+    double units = ns * 100.0;
+    int bucket = bucket_of(units >= 1.8e19 ? UINT64_MAX : (uint64_t)(units > 0 ? units : 0));
+    stats->counts[bucket]++;
+    stats->sums[bucket] += ns;
+    stats->references++;
+    stats->total_ns += ns;
+}
+
+double latency_percentile(const LatencyStats *stats, double p) {
+    if (stats->references == 0) {
+        return 0.0;
+    }
+    // Rank of the reference at the percentile (1-based)
+    long rank = (long)(p * stats->references + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    long seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += stats->counts[b];
+        if (seen >= rank) {
+            return stats->sums[b] / stats->counts[b];
+        }
+    }
+    return 0.0;
+}
@@ -0,0 +1,53 @@
+/**
+ * Project 4 - Simulated-time cost model
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Charges every translated reference a simulated latency: the L1 TLB
+ * lookup, the L2 lookup on an L1 miss, one memory access per page table
+ * level on a full TLB miss, the memory access itself, and the fault
+ * service time when a page has to be read from the backing store.
+ *
+ * Latencies go into a log-linear histogram (16 sub-buckets per power of
+ * two of 1/100 ns, so about 6% wide) that also keeps each bucket's sum.
+ * Percentiles report the mean of the bucket they fall in, which is exact
+ * whenever a bucket holds a single distinct latency - the usual case, as a
+ * reference can only take a handful of paths.
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#define LATENCY_SUB_BITS 4                        // log2(sub-buckets per power of two)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+// Latencies of each step of a translation
+typedef struct {
+    double l1_tlb_ns;      // L1 TLB lookup (every reference)
+    double l2_tlb_ns;      // L2 TLB lookup (L1 misses, with an L2)
+    double walk_ns;        // Page table walk, per level
+    double memory_ns;      // The memory access itself
+    double fault_us;       // Servicing a fault from the backing store
+} CostModel;
+
+// Per-reference latency histogram and totals
+typedef struct {
+    long counts[LATENCY_BUCKETS];
+    double sums[LATENCY_BUCKETS]; // Sum of the latencies in each bucket
+    long references;
+    double total_ns;       // Simulated time of all references
+    double fault_ns;       // ...spent servicing faults
+} LatencyStats;
+
+// Fill in the default costs
+void cost_model_init(CostModel *cost);
+
+// Record one reference's latency
+void latency_record(LatencyStats *stats, double ns);
+
+// Latency below which a fraction p (0-1) of the references fall
+double latency_percentile(const LatencyStats *stats, double p);
+
+#endif
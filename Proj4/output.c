@@ -0,0 +1,99 @@
+/**
+ * Project 4 - Buffered result output
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "output.h"
+
+void output_init(OutputBuffer *out, int fd) {
+    out->fd = fd;
+    out->len = 0;
+}
+
+void output_flush(OutputBuffer *out) {
+    size_t done = 0;
+    while (done < out->len) {
+        ssize_t written = write(out->fd, out->data + done, out->len - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            break;
+        }
+        done += written;
+    }
+    out->len = 0;
+}
+
+// Copy a string literal into the buffer
+static inline char *put_text(char *p, const char *text, size_t len) {
+    memcpy(p, text, len);
+    return p + len;
+}
+
+// Convert a signed integer to decimal text
+static inline char *put_long(char *p, long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long v = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    if (value < 0) {
+        *p++ = '-';
+    }
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+void output_translation(OutputBuffer *out, long virtual_address, long physical_address, int value) {
+    if (out->len + OUTPUT_LINE_MAX > OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+
+    char *p = out->data + out->len;
+    p = put_text(p, "Virtual address: ", 17);
+    p = put_long(p, virtual_address);
+    p = put_text(p, " Physical address: ", 19);
+    p = put_long(p, physical_address);
+    p = put_text(p, " Value: ", 8);
+    p = put_long(p, value);
+    *p++ = '\n';
+    out->len = p - out->data;
+}
+
+void output_printf(OutputBuffer *out, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(out->data + out->len, OUTPUT_BUFFER_SIZE - out->len, format, args);
+    va_end(args);
+
+    if (needed < 0) {
+        return;
+    }
+    if ((size_t)needed < OUTPUT_BUFFER_SIZE - out->len) {
+        out->len += needed;
+        return;
+    }
+
+    // Did not fit: flush and format again into the empty buffer
+    output_flush(out);
+    va_start(args, format);
+    needed = vsnprintf(out->data, OUTPUT_BUFFER_SIZE, format, args);
+    va_end(args);
+    if (needed > 0) {
+        out->len = (size_t)needed < OUTPUT_BUFFER_SIZE ? (size_t)needed : OUTPUT_BUFFER_SIZE - 1;
+    }
+}
@@ -0,0 +1,39 @@
+/**
+ * Project 4 - Buffered result output
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Translation results are formatted into a large reusable buffer with a
+ * hand-written integer-to-text conversion and written out with one write()
+ * per chunk, instead of one printf call per address.
+ */
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)  // Bytes buffered before a write()
+#define OUTPUT_LINE_MAX 96            // Longest line output_translation emits
+
+// Output buffer state
+typedef struct {
+    int fd;                           // Destination file descriptor
+    size_t len;                       // Bytes currently buffered
+    char data[OUTPUT_BUFFER_SIZE];    // Pending output
+} OutputBuffer;
+
+// Start buffering output for a file descriptor
+void output_init(OutputBuffer *out, int fd);
+
+// Append "Virtual address: V Physical address: P Value: X\n"
+void output_translation(OutputBuffer *out, long virtual_address, long physical_address, int value);
+
+// Append printf-style formatted text
+void output_printf(OutputBuffer *out, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// Write out everything buffered so far
+void output_flush(OutputBuffer *out);
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * Project 4 - Page number hash map
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include "pagemap.h"
+
+#define MIN_CAPACITY 16
+
+// Allocate empty slot arrays; returns 0 on success
+static int alloc_slots(PageMap *map, size_t capacity) {
+    map->keys = malloc(capacity * sizeof(int64_t));
+    map->values = malloc(capacity * sizeof(long));
+    if (map->keys == NULL || map->values == NULL) {
+        free(map->keys);
+        free(map->values);
+        map->keys = NULL;
+        map->values = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        map->keys[i] = PAGEMAP_EMPTY;
+    }
+    map->capacity = capacity;
+    map->count = 0;
+    return 0;
+}
+
+int pagemap_init(PageMap *map, size_t expected) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < expected * 2) {
+        capacity *= 2;
+    }
+    return alloc_slots(map, capacity);
+}
+
+void pagemap_destroy(PageMap *map) {
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+// Double the table and reinsert every key
+static int grow(PageMap *map) {
+    PageMap old = *map;
+    if (alloc_slots(map, old.capacity * 2) != 0) {
+        *map = old;
+        return -1;
+    }
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.keys[i] != PAGEMAP_EMPTY) {
+            pagemap_put(map, old.keys[i], old.values[i]);
+        }
+    }
+    pagemap_destroy(&old);
+    return 0;
+}
+
+int pagemap_put(PageMap *map, int64_t key, long value) {
+    // Keep the load factor at or below 1/2
+    if ((map->count + 1) * 2 > map->capacity && grow(map) != 0) {
+        return -1;
+    }
+
+    size_t i = pagemap_slot(map, key);
+    while (map->keys[i] != PAGEMAP_EMPTY && map->keys[i] != key) {
+        i = (i + 1) & (map->capacity - 1);
+    }
+    if (map->keys[i] == PAGEMAP_EMPTY) {
+        map->keys[i] = key;
+        map->count++;
+    }
+    map->values[i] = value;
+    return 0;
+}
+
+void pagemap_remove(PageMap *map, int64_t key) {
+    size_t mask = map->capacity - 1;
+    size_t i = pagemap_slot(map, key);
+    while (map->keys[i] != key) {
+        if (map->keys[i] == PAGEMAP_EMPTY) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Backward-shift deletion: move later entries of the probe run into the hole
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; map->keys[j] != PAGEMAP_EMPTY; j = (j + 1) & mask) {
+        size_t home = pagemap_slot(map, map->keys[j]);
+        // The entry may move only if its home slot is not between the hole and j
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            map->keys[hole] = map->keys[j];
+            map->values[hole] = map->values[j];
+            hole = j;
+        }
+    }
+    map->keys[hole] = PAGEMAP_EMPTY;
+    map->count--;
+}
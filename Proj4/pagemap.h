@@ -0,0 +1,58 @@
+/**
+ * Project 4 - Page number hash map
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Open-addressing (linear probing) map from page number to a long, for
+ * per-page state that used to live in arrays indexed by page number. With
+ * wide addresses those arrays would span the whole virtual space; the map
+ * only holds the pages actually seen. Removal shifts later entries back,
+ * so there are no tombstones and lookups stay short.
+ */
+#ifndef PAGEMAP_H
+#define PAGEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PAGEMAP_EMPTY (-1)     // Key stored in unused slots
+
+// Hash map state
+typedef struct {
+    int64_t *keys;         // Page number per slot, or PAGEMAP_EMPTY
+    long *values;          // Value per slot
+    size_t capacity;       // Number of slots (power of two)
+    size_t count;          // Number of keys stored
+} PageMap;
+
+// Spread a page number over the table (Fibonacci hashing)
+static inline size_t pagemap_slot(const PageMap *map, int64_t key) {
+    return (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> 32) & (map->capacity - 1);
+}
+
+// Set up a map sized for about `expected` keys; returns 0 on success
+int pagemap_init(PageMap *map, size_t expected);
+
+// Release the map
+void pagemap_destroy(PageMap *map);
+
+// Store a value (growing the map as needed); returns 0 on success
+int pagemap_put(PageMap *map, int64_t key, long value);
+
+// Remove a key (if present)
+void pagemap_remove(PageMap *map, int64_t key);
+
+// Look up a key; returns `missing` if it is not stored
+static inline long pagemap_get(const PageMap *map, int64_t key, long missing) {
+    for (size_t i = pagemap_slot(map, key); ; i = (i + 1) & (map->capacity - 1)) {
+        if (map->keys[i] == key) {
+            return map->values[i];
+        }
+        if (map->keys[i] == PAGEMAP_EMPTY) {
+            return missing;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * Project 4 - Radix page table
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "pagetable.h"
+
+int page_table_init(PageTable *pt, int page_number_bits, int levels) {
+    memset(pt, 0, sizeof(*pt));
+    if (levels == 0) {
+        levels = (page_number_bits + 9) / 10;
+        if (levels < 1) {
+            levels = 1;
+        } else if (levels > PT_MAX_LEVELS) {
+            levels = PT_MAX_LEVELS;
+        }
+    }
+    if (levels < 1 || levels > PT_MAX_LEVELS || levels > page_number_bits ||
+        (page_number_bits + levels - 1) / levels > 30) {
+        return -1;
+    }
+
+    // Spread the bits evenly; the root takes any remainder
+    pt->levels = levels;
+    int shift = page_number_bits;
+    for (int level = 0; level < levels; level++) {
+        pt->bits[level] = page_number_bits / levels + (level < page_number_bits % levels ? 1 : 0);
+        shift -= pt->bits[level];
+        pt->shift[level] = shift;
+    }
+    return 0;
+}
+
+// Free a table and everything below it
+static void free_table(void *table, const PageTable *pt, int level) {
+    if (table == NULL) {
+        return;
+    }
+    if (level < pt->levels - 1) {
+        void **entries = table;
+        for (size_t i = 0; i < (size_t)1 << pt->bits[level]; i++) {
+            free_table(entries[i], pt, level + 1);
+        }
+    }
+    free(table);
+}
+
+void page_table_destroy(PageTable *pt) {
+    free_table(pt->root, pt, 0);
+    pt->root = NULL;
+    pt->tables = 0;
+    pt->bytes = 0;
+}
+
+// Allocate a zeroed table for a level (all pointers NULL / entries invalid)
+static void *new_table(PageTable *pt, int level) {
+    size_t entry_size = level < pt->levels - 1 ? sizeof(void *) : sizeof(PageTableEntry);
+    size_t size = ((size_t)1 << pt->bits[level]) * entry_size;
+    void *table = calloc(1, size);
+    if (table != NULL) {
+        pt->tables++;
+        pt->bytes += size;
+    }
+    return table;
+}
+
+PageTableEntry *page_table_entry(PageTable *pt, int64_t page_number) {
+    if (pt->root == NULL && (pt->root = new_table(pt, 0)) == NULL) {
+        return NULL;
+    }
+
+    void *table = pt->root;
+    for (int level = 0; level < pt->levels - 1; level++) {
+        size_t index = (size_t)(page_number >> pt->shift[level]) & (((size_t)1 << pt->bits[level]) - 1);
+        void **slot = &((void **)table)[index];
+        if (*slot == NULL && (*slot = new_table(pt, level + 1)) == NULL) {
+            return NULL;
+        }
+        table = *slot;
+    }
+    size_t index = (size_t)page_number & (((size_t)1 << pt->bits[pt->levels - 1]) - 1);
+    return &((PageTableEntry *)table)[index];
+}
@@ -0,0 +1,66 @@
+/**
+ * Project 4 - Radix page table
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * A page number of `page_number_bits` bits is split into 1-4 index fields,
+ * root first, like the x86 paging structures. Interior tables hold pointers
+ * to the next level and leaf tables hold PageTableEntry records. Tables are
+ * allocated the first time a page under them is mapped, so memory grows
+ * with the pages touched rather than the size of the address space.
+ *
+ * With the default 16-bit addresses and 256-byte pages there is a single
+ * level: one 256-entry table, the same as the original flat array.
+ */
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PT_MAX_LEVELS 4
+
+// Page table entry with validity and dirty flags
+typedef struct {
+    int frame_number;
+    bool valid;
+    bool dirty;            // Written since it was loaded
+} PageTableEntry;
+
+// Page table state
+typedef struct {
+    int levels;                    // Number of levels (1-4)
+    int bits[PT_MAX_LEVELS];       // Index bits at each level, root first
+    int shift[PT_MAX_LEVELS];      // Page number shift for each level's index
+    void *root;                    // Root table (allocated on first use)
+    long tables;                   // Tables allocated so far
+    size_t bytes;                  // Bytes allocated for tables
+} PageTable;
+
+// Split page numbers into `levels` index fields (0 = pick about 10 bits per
+// level); returns 0 on success, -1 for an unsupported layout
+int page_table_init(PageTable *pt, int page_number_bits, int levels);
+
+// Free every table
+void page_table_destroy(PageTable *pt);
+
+// Entry for a page, allocating missing tables; NULL on allocation failure
+PageTableEntry *page_table_entry(PageTable *pt, int64_t page_number);
+
+// Entry for a page, or NULL if no table covers it yet
+static inline PageTableEntry *page_table_find(const PageTable *pt, int64_t page_number) {
+    void *table = pt->root;
+    for (int level = 0; level < pt->levels - 1 && table != NULL; level++) {
+        size_t index = (size_t)(page_number >> pt->shift[level]) & (((size_t)1 << pt->bits[level]) - 1);
+        table = ((void **)table)[index];
+    }
+    if (table == NULL) {
+        return NULL;
+    }
+    size_t index = (size_t)page_number & (((size_t)1 << pt->bits[pt->levels - 1]) - 1);
+    return &((PageTableEntry *)table)[index];
+}
+
+#endif
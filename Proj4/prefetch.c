@@ -0,0 +1,196 @@
+/**
+ * Project 4 - Page prefetcher
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "prefetch.h"
+
+int prefetch_kind_from_name(const char *name) {
+    if (strcmp(name, "none") == 0) {
+        return PREFETCH_NONE;
+    } else if (strcmp(name, "sequential") == 0) {
+        return PREFETCH_SEQUENTIAL;
+    } else if (strcmp(name, "stride") == 0) {
+        return PREFETCH_STRIDE;
+    } else if (strcmp(name, "markov") == 0) {
+        return PREFETCH_MARKOV;
+    }
+    return -1;
+}
+
+// I/O thread: read queued pages into their staging frames
+static void *io_thread(void *arg) {
+    Prefetcher *pf = arg;
+    pthread_mutex_lock(&pf->lock);
+    while (1) {
+        while (pf->queue_len == 0 && !pf->stop) {
+            pthread_cond_wait(&pf->cond, &pf->lock);
+        }
+        if (pf->queue_len == 0) {
+            break;
+        }
+        int slot = pf->queue[pf->queue_head];
+        pf->queue_head = (pf->queue_head + 1) % pf->slot_count;
+        pf->queue_len--;
+        int64_t page = pf->slot_page[slot];
+        pthread_mutex_unlock(&pf->lock);
+
+        // The main thread leaves a pending slot alone until it is ready
+        backing_store_read_page(pf->store, page, pf->data + (size_t)slot * pf->page_size);
+
+        pthread_mutex_lock(&pf->lock);
+        pf->slot_state[slot] = SLOT_READY;
+        pthread_cond_broadcast(&pf->cond);
+    }
+    pthread_mutex_unlock(&pf->lock);
+    return NULL;
+}
+
+int prefetch_init(Prefetcher *pf, PrefetchKind kind, int degree, int slot_count,
+                  BackingStore *store, int page_size) {
+    memset(pf, 0, sizeof(*pf));
+    pf->kind = kind;
+    pf->degree = degree;
+    pf->slot_count = slot_count;
+    pf->page_size = page_size;
+    pf->store = store;
+    pf->last_fault = -1;
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->cond, NULL);
+    if (degree <= 0 || degree > PREFETCH_MAX_DEGREE || slot_count <= 0) {
+        prefetch_destroy(pf);
+        return -1;
+    }
+
+    pf->slot_page = malloc(slot_count * sizeof(int64_t));
+    pf->slot_state = calloc(slot_count, sizeof(SlotState));
+    pf->data = malloc((size_t)slot_count * page_size);
+    pf->queue = malloc(slot_count * sizeof(int));
+    if (pf->slot_page == NULL || pf->slot_state == NULL || pf->data == NULL || pf->queue == NULL ||
+        pagemap_init(&pf->successor, 0) != 0) {
+        prefetch_destroy(pf);
+        return -1;
+    }
+    for (int i = 0; i < slot_count; i++) {
+        pf->slot_page[i] = -1;
+    }
+    if (pthread_create(&pf->thread, NULL, io_thread, pf) != 0) {
+        prefetch_destroy(pf);
+        return -1;
+    }
+    pf->started = true;
+    return 0;
+}
+
+void prefetch_destroy(Prefetcher *pf) {
+    if (pf->started) {
+        pthread_mutex_lock(&pf->lock);
+        pf->stop = true;
+        pthread_cond_broadcast(&pf->cond);
+        pthread_mutex_unlock(&pf->lock);
+        pthread_join(pf->thread, NULL);
+        pf->started = false;
+    }
+    free(pf->slot_page);
+    free(pf->slot_state);
+    free(pf->data);
+    free(pf->queue);
+    pagemap_destroy(&pf->successor);
+    pf->slot_page = NULL;
+    pf->slot_state = NULL;
+    pf->data = NULL;
+    pf->queue = NULL;
+    pthread_mutex_destroy(&pf->lock);
+    pthread_cond_destroy(&pf->cond);
+}
+
+int prefetch_predict(Prefetcher *pf, int64_t page_number, int64_t *out) {
+    int n = 0;
+    int64_t last = pf->last_fault;
+    int64_t stride = last == -1 ? 0 : page_number - last;
+
+    if (pf->kind == PREFETCH_SEQUENTIAL) {
+        for (int i = 1; i <= pf->degree; i++) {
+            out[n++] = page_number + i;
+        }
+    } else if (pf->kind == PREFETCH_STRIDE) {
+        // Predict only once the same stride has been seen twice in a row
+        if (stride != 0 && stride == pf->last_stride) {
+            for (int i = 1; i <= pf->degree; i++) {
+                out[n++] = page_number + i * stride;
+            }
+        }
+    } else if (pf->kind == PREFETCH_MARKOV) {
+        if (last != -1) {
+            pagemap_put(&pf->successor, last, page_number);
+        }
+        int64_t page = page_number;
+        for (int i = 0; i < pf->degree; i++) {
+            page = pagemap_get(&pf->successor, page, -1);
+            if (page == -1 || page == page_number) {
+                break;
+            }
+            out[n++] = page;
+        }
+    }
+
+    pf->last_stride = stride;
+    pf->last_fault = page_number;
+    return n;
+}
+
+// Staging slot holding a page, or -1
+static int find_slot(const Prefetcher *pf, int64_t page_number) {
+    for (int i = 0; i < pf->slot_count; i++) {
+        if (pf->slot_page[i] == page_number) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void prefetch_issue(Prefetcher *pf, int64_t page_number) {
+    if (find_slot(pf, page_number) != -1) {
+        return;
+    }
+
+    // Reuse the oldest slot, waiting for its read if it is still pending
+    int slot = pf->next_slot;
+    pf->next_slot = (slot + 1) % pf->slot_count;
+    pthread_mutex_lock(&pf->lock);
+    while (pf->slot_state[slot] == SLOT_PENDING) {
+        pthread_cond_wait(&pf->cond, &pf->lock);
+    }
+    pf->slot_page[slot] = page_number;
+    pf->slot_state[slot] = SLOT_PENDING;
+    pf->queue[(pf->queue_head + pf->queue_len) % pf->slot_count] = slot;
+    pf->queue_len++;
+    pf->issued++;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+bool prefetch_take(Prefetcher *pf, int64_t page_number, signed char *dest) {
+    int slot = find_slot(pf, page_number);
+    if (slot == -1) {
+        return false;
+    }
+
+    pthread_mutex_lock(&pf->lock);
+    if (pf->slot_state[slot] == SLOT_PENDING) {
+        pf->late++;
+        while (pf->slot_state[slot] == SLOT_PENDING) {
+            pthread_cond_wait(&pf->cond, &pf->lock);
+        }
+    }
+    pf->slot_state[slot] = SLOT_EMPTY;
+    pthread_mutex_unlock(&pf->lock);
+
+    memcpy(dest, pf->data + (size_t)slot * pf->page_size, pf->page_size);
+    pf->slot_page[slot] = -1;
+    pf->used++;
+    return true;
+}
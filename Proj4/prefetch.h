@@ -0,0 +1,102 @@
+/**
+ * Project 4 - Page prefetcher
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Predicts the next pages to fault from the stream of page faults and
+ * reads them from the backing store ahead of use, on a background I/O
+ * thread, into a small pool of spare staging frames (separate from the
+ * simulated physical memory, so prefetching never changes which pages the
+ * replacement policy evicts). A demand fault whose page is staged copies it
+ * from there instead of reading the store synchronously.
+ *
+ * Predictors:
+ * - sequential: the next `degree` pages after the faulting page
+ * - stride:     once two consecutive faults are the same distance apart,
+ *               the next `degree` pages continuing that stride
+ * - markov:     first-order Markov chain; follows the page that last
+ *               faulted after this one, up to `degree` steps
+ *
+ * Staging frames are reused in FIFO order. The main thread makes every
+ * prediction, issue and reuse decision, so the statistics do not depend on
+ * thread timing; the I/O thread only performs the reads.
+ */
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "backing_store.h"
+#include "pagemap.h"
+
+#define PREFETCH_NAMES "none|sequential|stride|markov"
+#define PREFETCH_DEGREE 2      // Default pages predicted per fault
+#define PREFETCH_MAX_DEGREE 16 // Most pages predicted per fault
+#define PREFETCH_FRAMES 16     // Default staging frames
+
+typedef enum {
+    PREFETCH_NONE,
+    PREFETCH_SEQUENTIAL,
+    PREFETCH_STRIDE,
+    PREFETCH_MARKOV
+} PrefetchKind;
+
+// State of a staging frame
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_PENDING,          // Queued for or being read by the I/O thread
+    SLOT_READY             // Holds the page's data
+} SlotState;
+
+// Prefetcher state
+typedef struct {
+    PrefetchKind kind;
+    int degree;            // Pages predicted per fault
+    int slot_count;        // Staging frames
+    int page_size;
+    BackingStore *store;
+    int64_t *slot_page;    // Page staged in each slot, or -1
+    SlotState *slot_state; // Guarded by lock
+    signed char *data;     // page_size bytes per slot
+    int next_slot;         // Next slot to reuse (FIFO)
+    int *queue;            // Slots waiting for the I/O thread (ring)
+    int queue_head;
+    int queue_len;
+    bool stop;
+    bool started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int64_t last_fault;    // Previous faulting page (-1 before the first)
+    int64_t last_stride;   // Distance between the previous two faults
+    PageMap successor;     // Markov: page that last faulted after each page
+    long issued;           // Prefetch reads issued
+    long used;             // Staged pages consumed by demand faults
+    long late;             // ...of which the read had not finished yet
+} Prefetcher;
+
+// Parse a predictor name; returns -1 if unknown
+int prefetch_kind_from_name(const char *name);
+
+// Set up a prefetcher (degree 1-PREFETCH_MAX_DEGREE) and start its I/O
+// thread; returns 0 on success
+int prefetch_init(Prefetcher *pf, PrefetchKind kind, int degree, int slot_count,
+                  BackingStore *store, int page_size);
+
+// Stop the I/O thread and release the staging frames
+void prefetch_destroy(Prefetcher *pf);
+
+// Record a demand fault and fill out[] with up to `degree` predicted pages
+// (not yet filtered for residency); returns how many
+int prefetch_predict(Prefetcher *pf, int64_t page_number, int64_t *out);
+
+// Start reading a page into a staging frame (ignored if already staged)
+void prefetch_issue(Prefetcher *pf, int64_t page_number);
+
+// If a page is staged, copy it into dest (waiting for its read if needed),
+// free its staging frame and return true
+bool prefetch_take(Prefetcher *pf, int64_t page_number, signed char *dest);
+
+#endif
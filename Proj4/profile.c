@@ -0,0 +1,466 @@
+/**
+ * Project 4 - Streaming working-set and locality profiler
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Every page is hashed once per reference. The hash drives everything:
+ * the bottom-k sketches keep the smallest hashes, the count-min rows take
+ * one 16-bit slice of it each, and a page is sampled for reuse distances
+ * while its hash is below the sampling threshold.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+#define HASH_RANGE 18446744073709551616.0  // 2^64
+
+// splitmix64 finalizer
+static inline uint64_t hash_page(int64_t page) {
+    uint64_t x = (uint64_t)page + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Log-linear histogram bucket of a value, and the smallest value in a bucket
+static int bucket_of(uint64_t value) {
+    if (value < (1u << PROFILE_SUB_BITS)) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    return ((msb - PROFILE_SUB_BITS + 1) << PROFILE_SUB_BITS) +
+           (int)((value >> (msb - PROFILE_SUB_BITS)) & ((1u << PROFILE_SUB_BITS) - 1));
+}
+
+static uint64_t bucket_low(int bucket) {
+    if (bucket < (1 << PROFILE_SUB_BITS)) {
+        return (uint64_t)bucket;
+    }
+    int msb = (bucket >> PROFILE_SUB_BITS) + PROFILE_SUB_BITS - 1;
+    return (uint64_t)((1 << PROFILE_SUB_BITS) + (bucket & ((1 << PROFILE_SUB_BITS) - 1)))
+           << (msb - PROFILE_SUB_BITS);
+}
+
+// Largest value in a bucket
+static uint64_t bucket_high(int bucket) {
+    return bucket + 1 < PROFILE_BUCKETS ? bucket_low(bucket + 1) - 1 : UINT64_MAX;
+}
+
+// Smallest bucket upper bound covering a share of a histogram's weight
+static uint64_t histogram_percentile(const double *histogram, double share) {
+    double total = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        total += histogram[b];
+    }
+    double seen = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        seen += histogram[b];
+        if (histogram[b] > 0 && seen >= share * total) {
+            return bucket_high(b);
+        }
+    }
+    return 0;
+}
+
+static int bottomk_init(BottomK *set, int capacity) {
+    set->hashes = malloc(capacity * sizeof(uint64_t));
+    set->count = 0;
+    set->capacity = capacity;
+    return set->hashes != NULL ? 0 : -1;
+}
+
+static void bottomk_add(BottomK *set, uint64_t hash) {
+    if (set->count == set->capacity && hash >= set->hashes[set->count - 1]) {
+        return;
+    }
+    int lo = 0;
+    int hi = set->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (set->hashes[mid] < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < set->count && set->hashes[lo] == hash) {
+        return;
+    }
+    // A full set drops its largest hash
+    int kept = set->count < set->capacity ? set->count : set->capacity - 1;
+    memmove(&set->hashes[lo + 1], &set->hashes[lo], (kept - lo) * sizeof(uint64_t));
+    set->hashes[lo] = hash;
+    if (set->count < set->capacity) {
+        set->count++;
+    }
+}
+
+// Distinct elements of the set (exact until it fills)
+static double bottomk_estimate(const BottomK *set) {
+    if (set->count < set->capacity) {
+        return set->count;
+    }
+    return (set->capacity - 1) / ((double)set->hashes[set->capacity - 1] / HASH_RANGE);
+}
+
+// Jaccard similarity: the share of the union's smallest hashes in both sets
+static double bottomk_similarity(const BottomK *a, const BottomK *b) {
+    int i = 0;
+    int j = 0;
+    int taken = 0;
+    int both = 0;
+    while (taken < a->capacity && (i < a->count || j < b->count)) {
+        if (j == b->count || (i < a->count && a->hashes[i] < b->hashes[j])) {
+            i++;
+        } else if (i == a->count || b->hashes[j] < a->hashes[i]) {
+            j++;
+        } else {
+            both++;
+            i++;
+            j++;
+        }
+        taken++;
+    }
+    return taken > 0 ? (double)both / taken : 1.0;
+}
+
+int profile_init(Profile *profile, long window, int top_k, int max_samples, FILE *series) {
+    memset(profile, 0, sizeof(*profile));
+    if (window <= 0 || top_k < 0 || top_k > MAX_TOP_K || max_samples <= 0) {
+        return -1;
+    }
+    profile->window = window;
+    profile->top_k = top_k;
+    profile->max_samples = max_samples;
+    profile->series = series;
+    profile->threshold = UINT64_MAX;
+
+    profile->sketch = calloc((size_t)SKETCH_DEPTH * SKETCH_WIDTH, sizeof(uint64_t));
+    profile->top_pages = malloc((top_k + 1) * sizeof(int64_t));
+    profile->top_counts = malloc((top_k + 1) * sizeof(uint64_t));
+    profile->heap_hashes = malloc((max_samples + 1) * sizeof(uint64_t));
+    profile->heap_pages = malloc((max_samples + 1) * sizeof(int64_t));
+    if (profile->sketch == NULL || profile->top_pages == NULL || profile->top_counts == NULL ||
+        profile->heap_hashes == NULL || profile->heap_pages == NULL ||
+        bottomk_init(&profile->current, WINDOW_SKETCH) != 0 ||
+        bottomk_init(&profile->previous, WINDOW_SKETCH) != 0 ||
+        bottomk_init(&profile->distinct, DISTINCT_SKETCH) != 0 ||
+        pagemap_init(&profile->top_index, top_k + 1) != 0 ||
+        stackdist_init(&profile->stack, 1) != 0) {
+        profile_destroy(profile);
+        return -1;
+    }
+    if (series != NULL) {
+        fprintf(series, "window,start,working_set,similarity,phase_change\n");
+    }
+    return 0;
+}
+
+void profile_destroy(Profile *profile) {
+    free(profile->current.hashes);
+    free(profile->previous.hashes);
+    free(profile->distinct.hashes);
+    free(profile->sketch);
+    free(profile->top_pages);
+    free(profile->top_counts);
+    free(profile->heap_hashes);
+    free(profile->heap_pages);
+    pagemap_destroy(&profile->top_index);
+    stackdist_destroy(&profile->stack);
+    memset(profile, 0, sizeof(*profile));
+}
+
+static void end_window(Profile *profile) {
+    double working_set = bottomk_estimate(&profile->current);
+    long start = profile->references - profile->window_references;
+    double similarity = -1;
+    bool phase_change = false;
+    if (profile->windows > 0) {
+        similarity = bottomk_similarity(&profile->previous, &profile->current);
+        phase_change = similarity < PHASE_SIMILARITY;
+    }
+    if (phase_change) {
+        profile->phase_changes++;
+        if (profile->phases_listed < MAX_PHASES_LISTED) {
+            ProfilePhase *phase = &profile->phases[profile->phases_listed++];
+            phase->start = start;
+            phase->before = bottomk_estimate(&profile->previous);
+            phase->after = working_set;
+            phase->similarity = similarity;
+        }
+    }
+
+    if (profile->windows == 0 || working_set < profile->ws_min) {
+        profile->ws_min = working_set;
+    }
+    if (working_set > profile->ws_max) {
+        profile->ws_max = working_set;
+    }
+    profile->ws_sum += working_set;
+    profile->ws_histogram[bucket_of((uint64_t)(working_set + 0.5))]++;
+    if (profile->series != NULL) {
+        fprintf(profile->series, "%ld,%ld,%.0f,", profile->windows, start, working_set);
+        if (similarity >= 0) {
+            fprintf(profile->series, "%.3f", similarity);
+        }
+        fprintf(profile->series, ",%d\n", phase_change ? 1 : 0);
+    }
+    profile->windows++;
+
+    // This window becomes the previous one
+    BottomK finished = profile->current;
+    profile->current = profile->previous;
+    profile->previous = finished;
+    profile->current.count = 0;
+    profile->window_references = 0;
+}
+
+static void find_top_min(Profile *profile) {
+    profile->top_min = 0;
+    for (int i = 1; i < profile->top_count; i++) {
+        if (profile->top_counts[i] < profile->top_counts[profile->top_min]) {
+            profile->top_min = i;
+        }
+    }
+}
+
+// Count a reference in the sketch and keep the top set current
+static int count_page(Profile *profile, int64_t page, uint64_t hash) {
+    // Each row is indexed by its own 16-bit slice of the hash
+    uint64_t *counters[SKETCH_DEPTH];
+    uint64_t estimate = UINT64_MAX;
+    for (int r = 0; r < SKETCH_DEPTH; r++) {
+        counters[r] = &profile->sketch[(size_t)r * SKETCH_WIDTH + ((hash >> (16 * r)) & (SKETCH_WIDTH - 1))];
+        if (*counters[r] < estimate) {
+            estimate = *counters[r];
+        }
+    }
+    estimate++;
+
+    // Conservative update: only raise counters below the new estimate
+    for (int r = 0; r < SKETCH_DEPTH; r++) {
+        if (*counters[r] < estimate) {
+            *counters[r] = estimate;
+        }
+    }
+
+    if (profile->top_k == 0) {
+        return 0;
+    }
+    long index = pagemap_get(&profile->top_index, page, -1);
+    if (index != -1) {
+        profile->top_counts[index] = estimate;
+        if (index == profile->top_min) {
+            find_top_min(profile);
+        }
+        return 0;
+    }
+    if (profile->top_count < profile->top_k) {
+        index = profile->top_count++;
+    } else if (estimate > profile->top_counts[profile->top_min]) {
+        index = profile->top_min;
+        pagemap_remove(&profile->top_index, profile->top_pages[index]);
+    } else {
+        return 0;
+    }
+    profile->top_pages[index] = page;
+    profile->top_counts[index] = estimate;
+    find_top_min(profile);
+    return pagemap_put(&profile->top_index, page, index);
+}
+
+static void heap_push(Profile *profile, uint64_t hash, int64_t page) {
+    int i = profile->heap_count++;
+    while (i > 0 && profile->heap_hashes[(i - 1) / 2] < hash) {
+        profile->heap_hashes[i] = profile->heap_hashes[(i - 1) / 2];
+        profile->heap_pages[i] = profile->heap_pages[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    profile->heap_hashes[i] = hash;
+    profile->heap_pages[i] = page;
+}
+
+// Remove the sampled page with the largest hash
+static void heap_pop(Profile *profile, uint64_t *hash, int64_t *page) {
+    *hash = profile->heap_hashes[0];
+    *page = profile->heap_pages[0];
+    uint64_t last_hash = profile->heap_hashes[--profile->heap_count];
+    int64_t last_page = profile->heap_pages[profile->heap_count];
+    int i = 0;
+    while (2 * i + 1 < profile->heap_count) {
+        int child = 2 * i + 1;
+        if (child + 1 < profile->heap_count && profile->heap_hashes[child + 1] > profile->heap_hashes[child]) {
+            child++;
+        }
+        if (profile->heap_hashes[child] <= last_hash) {
+            break;
+        }
+        profile->heap_hashes[i] = profile->heap_hashes[child];
+        profile->heap_pages[i] = profile->heap_pages[child];
+        i = child;
+    }
+    profile->heap_hashes[i] = last_hash;
+    profile->heap_pages[i] = last_page;
+}
+
+// Reuse distance of a sampled page, scaled up by the sampling rate
+static int sample(Profile *profile, int64_t page, uint64_t hash) {
+    double rate = profile->threshold / HASH_RANGE;
+    long distance = stackdist_access(&profile->stack, page);
+    if (distance < 0) {
+        return -1;
+    }
+    if (distance > 0) {
+        profile->reuse_histogram[bucket_of((uint64_t)(distance / rate + 0.5))] += 1 / rate;
+        return 0;
+    }
+
+    profile->cold += 1 / rate;
+    heap_push(profile, hash, page);
+    if (profile->heap_count > profile->max_samples) {
+        // Drop the largest hash and stop sampling pages at or above it
+        uint64_t dropped_hash;
+        int64_t dropped;
+        heap_pop(profile, &dropped_hash, &dropped);
+        profile->threshold = dropped_hash;
+        stackdist_forget(&profile->stack, dropped);
+    }
+    return 0;
+}
+
+int profile_reference(Profile *profile, int64_t page) {
+    uint64_t hash = hash_page(page);
+    profile->references++;
+
+    bottomk_add(&profile->current, hash);
+    bottomk_add(&profile->distinct, hash);
+    if (++profile->window_references == profile->window) {
+        end_window(profile);
+    }
+    if (count_page(profile, page, hash) != 0) {
+        return -1;
+    }
+    return hash < profile->threshold ? sample(profile, page, hash) : 0;
+}
+
+void profile_finish(Profile *profile) {
+    if (profile->windows == 0 && profile->window_references > 0) {
+        end_window(profile);
+    }
+}
+
+static void print_page(FILE *out, int64_t page, int vpn_bits, bool has_asids) {
+    if (has_asids) {
+        fprintf(out, "%lld:%lld", (long long)(page >> vpn_bits),
+                (long long)(page & (((int64_t)1 << vpn_bits) - 1)));
+    } else {
+        fprintf(out, "%lld", (long long)page);
+    }
+}
+
+void profile_report(const Profile *profile, FILE *out, int vpn_bits, bool has_asids) {
+    long refs = profile->references;
+    fprintf(out, "Profiled References = %ld\n", refs);
+    if (refs == 0) {
+        return;
+    }
+    bool exact = profile->distinct.count < profile->distinct.capacity;
+    fprintf(out, "Distinct Pages = %s%.0f\n", exact ? "" : "~", bottomk_estimate(&profile->distinct));
+
+    // Working sets
+    long window = profile->windows == 1 && refs < profile->window ? refs : profile->window;
+    fprintf(out, "\nWorking Set (distinct pages per %ld references, %ld windows):\n", window, profile->windows);
+    // Percentiles are bucket upper bounds, so cap them at the maximum
+    double p50 = (double)histogram_percentile(profile->ws_histogram, 0.50);
+    double p95 = (double)histogram_percentile(profile->ws_histogram, 0.95);
+    fprintf(out, "  mean %.1f, min %.0f, p50 <= %.0f, p95 <= %.0f, max %.0f\n",
+            profile->ws_sum / profile->windows, profile->ws_min, p50 < profile->ws_max ? p50 : profile->ws_max,
+            p95 < profile->ws_max ? p95 : profile->ws_max, profile->ws_max);
+    fprintf(out, "Phase Changes = %ld (windows under %.0f%% similar to the one before)\n",
+            profile->phase_changes, PHASE_SIMILARITY * 100);
+    for (int i = 0; i < profile->phases_listed; i++) {
+        const ProfilePhase *phase = &profile->phases[i];
+        fprintf(out, "  at reference %ld: working set %.0f -> %.0f (similarity %.2f)\n",
+                phase->start, phase->before, phase->after, phase->similarity);
+    }
+    if (profile->phase_changes > profile->phases_listed) {
+        fprintf(out, "  ... %ld more\n", profile->phase_changes - profile->phases_listed);
+    }
+
+    // Popularity, most referenced first
+    if (profile->top_count > 0) {
+        int order[MAX_TOP_K];
+        for (int i = 0; i < profile->top_count; i++) {
+            int j = i;
+            while (j > 0 && profile->top_counts[order[j - 1]] < profile->top_counts[i]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        uint64_t covered = 0;
+        fprintf(out, "\nTop %d Pages (count-min estimates):\n", profile->top_count);
+        for (int i = 0; i < profile->top_count; i++) {
+            uint64_t count = profile->top_counts[order[i]];
+            covered += count;
+            fprintf(out, "  page ");
+            print_page(out, profile->top_pages[order[i]], vpn_bits, has_asids);
+            fprintf(out, ": %llu references (%.2f%%)\n", (unsigned long long)count, 100.0 * count / refs);
+        }
+        fprintf(out, "  top %d together: %.2f%% of references\n", profile->top_count,
+                covered > (uint64_t)refs ? 100.0 : 100.0 * covered / refs);
+    }
+
+    // Reuse distances, grouped by power of two. SHARDS-adj: sampled weight
+    // missing from (or beyond) the trace length belongs mostly to hot pages
+    // the sample happened to miss, so it is added to the shortest distance.
+    double histogram[PROFILE_BUCKETS];
+    memcpy(histogram, profile->reuse_histogram, sizeof(histogram));
+    double reuses = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        reuses += histogram[b];
+    }
+    double adjustment = refs - (reuses + profile->cold);
+    if (histogram[1] + adjustment < 0) {
+        adjustment = -histogram[1];
+    }
+    histogram[1] += adjustment;
+    reuses += adjustment;
+    double total = reuses + profile->cold;
+    fprintf(out, "\nReuse Distance (LRU stack distance; %d pages sampled at rate %.4f):\n",
+            profile->heap_count, profile->threshold / HASH_RANGE);
+    fprintf(out, "  %-20s %7.2f%%\n", "first reference", 100.0 * profile->cold / total);
+    double cumulative = 0;
+    for (int group = 0; group < 64; group++) {
+        uint64_t low = (uint64_t)1 << group;
+        uint64_t high = group == 63 ? UINT64_MAX : (low << 1) - 1;
+        double weight = 0;
+        for (int b = bucket_of(low); b < PROFILE_BUCKETS && bucket_low(b) <= high; b++) {
+            weight += histogram[b];
+        }
+        if (weight == 0) {
+            continue;
+        }
+        cumulative += weight;
+        char range[48];
+        if (low == high) {
+            snprintf(range, sizeof(range), "%llu", (unsigned long long)low);
+        } else {
+            snprintf(range, sizeof(range), "%llu-%llu", (unsigned long long)low, (unsigned long long)high);
+        }
+        fprintf(out, "  %-20s %7.2f%%  (LRU hit ratio with %llu frames: %.3f)\n", range,
+                100.0 * weight / total, (unsigned long long)high, cumulative / total);
+    }
+
+    // Frame counts that capture a share of the reuses
+    if (reuses > 0) {
+        fprintf(out, "Frames for LRU to hit ");
+        const double shares[] = {0.50, 0.90, 0.95, 0.99};
+        for (int i = 0; i < 4; i++) {
+            fprintf(out, "%s%.0f%% of reuses: %llu", i > 0 ? ", " : "", shares[i] * 100,
+                    (unsigned long long)histogram_percentile(histogram, shares[i]));
+        }
+        fprintf(out, "\n");
+    }
+}
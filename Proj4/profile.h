@@ -0,0 +1,118 @@
+/**
+ * Project 4 - Streaming working-set and locality profiler
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * One pass over a trace's page numbers, in memory that does not grow with
+ * the trace length or the number of distinct pages:
+ * - Working set: the distinct pages in each window of `window` references,
+ *   estimated with a bottom-k sketch (the WINDOW_SKETCH smallest page
+ *   hashes; exact while a window touches fewer pages than that)
+ * - Phase changes: windows whose pages are less than PHASE_SIMILARITY
+ *   similar (Jaccard, from the same sketches) to the previous window's
+ * - Popularity: reference counts from a count-min sketch with conservative
+ *   update, and the top_k pages by estimated count
+ * - Reuse distance: LRU stack distances (see stackdist.h) of a spatially
+ *   hashed sample of the pages (SHARDS), scaled by the sampling rate. The
+ *   sample is capped at max_samples pages; when it fills, the page with
+ *   the largest hash is dropped and the rate lowered to exclude it.
+ *
+ * Histograms are log-linear (PROFILE_SUB_BITS sub-buckets per power of
+ * two), so their size is fixed too.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pagemap.h"
+#include "stackdist.h"
+
+#define PROFILE_WINDOW 10000   // Default references per working-set window
+#define PROFILE_TOP_K 10       // Default popular pages reported
+#define MAX_TOP_K 1000
+#define PROFILE_SAMPLES 8192   // Default pages sampled for reuse distances
+#define SKETCH_DEPTH 4         // Count-min rows
+#define SKETCH_WIDTH (1 << 16) // Count-min counters per row
+#define WINDOW_SKETCH 256      // Bottom-k size of each window's sketch
+#define DISTINCT_SKETCH 1024   // Bottom-k size of the whole trace's sketch
+#define PHASE_SIMILARITY 0.5   // Windows less similar than this start a phase
+#define MAX_PHASES_LISTED 20
+#define PROFILE_SUB_BITS 3
+#define PROFILE_BUCKETS ((64 - PROFILE_SUB_BITS + 1) << PROFILE_SUB_BITS)
+
+// The smallest `capacity` hashes of a set, ascending
+typedef struct {
+    uint64_t *hashes;
+    int count;
+    int capacity;
+} BottomK;
+
+// A window that started a new phase
+typedef struct {
+    long start;                  // Reference index where the window starts
+    double before;               // Working set of the previous window
+    double after;                // Working set of this window
+    double similarity;
+} ProfilePhase;
+
+// Profiler state
+typedef struct {
+    long window;
+    int top_k;
+    int max_samples;
+    FILE *series;                // Per-window CSV (may be NULL)
+    long references;
+
+    // Working sets and phases
+    BottomK current;             // Pages of the window in progress
+    BottomK previous;            // Pages of the last finished window
+    BottomK distinct;            // Pages of the whole trace
+    long window_references;      // References in the window in progress
+    long windows;                // Finished windows
+    double ws_sum;
+    double ws_min;
+    double ws_max;
+    double ws_histogram[PROFILE_BUCKETS];
+    long phase_changes;
+    int phases_listed;
+    ProfilePhase phases[MAX_PHASES_LISTED];
+
+    // Popularity
+    uint64_t *sketch;            // SKETCH_DEPTH rows of SKETCH_WIDTH counters
+    int64_t *top_pages;
+    uint64_t *top_counts;
+    int top_count;
+    int top_min;                 // Index of the smallest count in the top set
+    PageMap top_index;           // Page -> index in the top set
+
+    // Reuse distances of the sampled pages
+    StackDistance stack;
+    uint64_t threshold;          // Pages whose hash is below this are sampled
+    uint64_t *heap_hashes;       // Max-heap of the sampled pages by hash
+    int64_t *heap_pages;
+    int heap_count;
+    double reuse_histogram[PROFILE_BUCKETS]; // Scaled references per distance bucket
+    double cold;                 // Scaled first references
+} Profile;
+
+// Set up a profiler; returns 0 on success, -1 for bad parameters or on
+// allocation failure
+int profile_init(Profile *profile, long window, int top_k, int max_samples, FILE *series);
+
+// Release the profiler's memory
+void profile_destroy(Profile *profile);
+
+// Record one reference; returns 0 on success, -1 on allocation failure
+int profile_reference(Profile *profile, int64_t page);
+
+// Close the last window (counted only if no full window was seen)
+void profile_finish(Profile *profile);
+
+// Print the report; page keys with ASIDs above bit vpn_bits are shown as
+// asid:page when has_asids
+void profile_report(const Profile *profile, FILE *out, int vpn_bits, bool has_asids);
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * Project 4 - Page table organization benchmark
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ * Usage: ./pt_bench [references] [frame_count]
+ * Build: gcc -O2 -pthread -o pt_bench pt_bench.c vmm.c pagetable.c invpt.c pagemap.c
+ *        writeback.c prefetch.c latency.c hugepage.c tlb.c replace.c backing_store.c
+ *
+ * Replays a synthetic sparse 48-bit trace (4 KB pages scattered in small
+ * clusters over the whole address space, with some locality) through the
+ * statistics-only simulator once with the radix page table and once with
+ * the inverted page table, and reports time per reference and the memory
+ * each table ended up using. Fault counts must match.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "vmm.h"
+
+#define ADDRESS_WIDTH 48
+#define BENCH_PAGE_SIZE 4096
+#define CLUSTERS 65536         // Scattered regions of the address space
+#define CLUSTER_PAGES 16       // Pages per region
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Run the trace through one page table organization; returns ns/reference
+static double run(const char *page_table, int frame_count, const uint64_t *addresses, long count,
+                  long *faults, size_t *bytes) {
+    VmmConfig config;
+    vmm_config_init(&config);
+    config.address_bits = ADDRESS_WIDTH;
+    config.page_size = BENCH_PAGE_SIZE;
+    config.page_table = page_table;
+    config.frame_count = frame_count;
+    Vmm *vm = vmm_create(&config, NULL);
+    if (vm == NULL) {
+        return -1;
+    }
+
+    double start = now_ns();
+    signed char value;
+    for (long i = 0; i < count; i++) {
+        vmm_access(vm, addresses[i], false, &value);
+        if (vm->failed) {
+            vmm_destroy(vm);
+            return -1;
+        }
+    }
+    double ns = (now_ns() - start) / count;
+
+    *faults = vm->page_faults;
+    if (vm->inverted) {
+        *bytes = vm->inverted_table.bytes;
+    } else {
+        vmm_page_tables(vm, bytes);
+    }
+    vmm_destroy(vm);
+    return ns;
+}
+
+int main(int argc, char *argv[]) {
+    long count = argc > 1 ? atol(argv[1]) : 5000000;
+    int frame_count = argc > 2 ? atoi(argv[2]) : 16384;
+    if (count <= 0 || frame_count <= 0) {
+        fprintf(stderr, "Usage: %s [references] [frame_count]\n", argv[0]);
+        return -1;
+    }
+
+    uint64_t *clusters = malloc(CLUSTERS * sizeof(uint64_t));
+    uint64_t *addresses = malloc(count * sizeof(uint64_t));
+    if (clusters == NULL || addresses == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(clusters);
+        free(addresses);
+        return -1;
+    }
+
+    // Clusters start at random page numbers anywhere in the 36-bit page space;
+    // references walk through a cluster, then jump to another one
+    uint64_t state = 88172645463325252ULL;
+    for (int c = 0; c < CLUSTERS; c++) {
+        clusters[c] = next_random(&state) & ((1ULL << (ADDRESS_WIDTH - 12)) - 1);
+    }
+    uint64_t cluster = 0;
+    for (long i = 0; i < count; i++) {
+        if (i % 64 == 0) {
+            cluster = clusters[next_random(&state) % CLUSTERS];
+        }
+        uint64_t page = cluster + next_random(&state) % CLUSTER_PAGES;
+        addresses[i] = (page << 12) | (next_random(&state) & (BENCH_PAGE_SIZE - 1));
+    }
+
+    long radix_faults, inverted_faults;
+    size_t radix_bytes, inverted_bytes;
+    double radix_ns = run("radix", frame_count, addresses, count, &radix_faults, &radix_bytes);
+    double inverted_ns = run("inverted", frame_count, addresses, count, &inverted_faults, &inverted_bytes);
+    free(clusters);
+    free(addresses);
+    if (radix_ns < 0 || inverted_ns < 0) {
+        return -1;
+    }
+    if (radix_faults != inverted_faults) {
+        fprintf(stderr, "Error: Fault counts differ (%ld vs %ld)\n", radix_faults, inverted_faults);
+        return -1;
+    }
+
+    printf("References: %ld, frames: %d, page faults: %ld\n", count, frame_count, radix_faults);
+    printf("Radix page table:    %.2f ns/reference, %zu bytes\n", radix_ns, radix_bytes);
+    printf("Inverted page table: %.2f ns/reference, %zu bytes\n", inverted_ns, inverted_bytes);
+    return 0;
+}
@@ -0,0 +1,899 @@
+/**
+ * Project 4 - Page replacement policies
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "replace.h"
+#include "pagemap.h"
+
+// ---------------------------------------------------------------------------
+// Intrusive doubly-linked lists over node indices (shared by LRU, LFU, ARC,
+// WS and PFF)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int head;   // Most recently inserted node
+    int tail;   // Least recently inserted node
+    int size;
+} IndexList;
+
+static void list_init(IndexList *list) {
+    list->head = -1;
+    list->tail = -1;
+    list->size = 0;
+}
+
+static void list_remove(IndexList *list, int *prev, int *next, int node) {
+    if (prev[node] != -1) {
+        next[prev[node]] = next[node];
+    } else {
+        list->head = next[node];
+    }
+    if (next[node] != -1) {
+        prev[next[node]] = prev[node];
+    } else {
+        list->tail = prev[node];
+    }
+    prev[node] = -1;
+    next[node] = -1;
+    list->size--;
+}
+
+static void list_push_front(IndexList *list, int *prev, int *next, int node) {
+    prev[node] = -1;
+    next[node] = list->head;
+    if (list->head != -1) {
+        prev[list->head] = node;
+    }
+    list->head = node;
+    if (list->tail == -1) {
+        list->tail = node;
+    }
+    list->size++;
+}
+
+// Allocate an int array filled with -1
+static int *alloc_indices(int count) {
+    int *array = malloc(count * sizeof(int));
+    if (array != NULL) {
+        for (int i = 0; i < count; i++) {
+            array[i] = -1;
+        }
+    }
+    return array;
+}
+
+// ---------------------------------------------------------------------------
+// FIFO: frames fill in order 0..n-1 and each victim is refilled in place,
+// so load order is simply round robin over the frames
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    ReplacementPolicy base;
+    int frame_count;
+    int next;   // Oldest frame
+} FifoPolicy;
+
+static void fifo_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    (void)policy; (void)frame; (void)page; (void)time;
+}
+
+static void fifo_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    (void)policy; (void)frame; (void)page; (void)time;
+}
+
+static int fifo_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    FifoPolicy *fifo = (FifoPolicy *)policy;
+    (void)page; (void)time;
+    int frame = fifo->next;
+    fifo->next = (fifo->next + 1) % fifo->frame_count;
+    return frame;
+}
+
+static void fifo_destroy(ReplacementPolicy *policy) {
+    free(policy);
+}
+
+static ReplacementPolicy *fifo_create(int frame_count) {
+    FifoPolicy *fifo = calloc(1, sizeof(FifoPolicy));
+    if (fifo == NULL) {
+        return NULL;
+    }
+    fifo->frame_count = frame_count;
+    fifo->next = 0;
+    return &fifo->base;
+}
+
+// ---------------------------------------------------------------------------
+// LRU: frames in a doubly-linked list from most to least recently used
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    ReplacementPolicy base;
+    IndexList list;
+    int *prev;
+    int *next;
+} LruPolicy;
+
+static void lru_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LruPolicy *lru = (LruPolicy *)policy;
+    (void)page; (void)time;
+    if (lru->list.head != frame) {
+        list_remove(&lru->list, lru->prev, lru->next, frame);
+        list_push_front(&lru->list, lru->prev, lru->next, frame);
+    }
+}
+
+static void lru_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LruPolicy *lru = (LruPolicy *)policy;
+    (void)page; (void)time;
+    list_push_front(&lru->list, lru->prev, lru->next, frame);
+}
+
+static int lru_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    LruPolicy *lru = (LruPolicy *)policy;
+    (void)page; (void)time;
+    int frame = lru->list.tail;
+    list_remove(&lru->list, lru->prev, lru->next, frame);
+    return frame;
+}
+
+static void lru_destroy(ReplacementPolicy *policy) {
+    LruPolicy *lru = (LruPolicy *)policy;
+    free(lru->prev);
+    free(lru->next);
+    free(lru);
+}
+
+static ReplacementPolicy *lru_create(int frame_count) {
+    LruPolicy *lru = calloc(1, sizeof(LruPolicy));
+    if (lru == NULL) {
+        return NULL;
+    }
+    list_init(&lru->list);
+    lru->prev = alloc_indices(frame_count);
+    lru->next = alloc_indices(frame_count);
+    if (lru->prev == NULL || lru->next == NULL) {
+        lru_destroy(&lru->base);
+        return NULL;
+    }
+    return &lru->base;
+}
+
+// ---------------------------------------------------------------------------
+// Clock (second chance): a hand sweeps the frames, clearing reference bits,
+// and evicts the first frame whose bit is already clear
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    ReplacementPolicy base;
+    int frame_count;
+    int hand;
+    unsigned char *referenced;
+} ClockPolicy;
+
+static void clock_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    ClockPolicy *clock = (ClockPolicy *)policy;
+    (void)page; (void)time;
+    clock->referenced[frame] = 1;
+}
+
+static int clock_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    ClockPolicy *clock = (ClockPolicy *)policy;
+    (void)page; (void)time;
+    while (clock->referenced[clock->hand]) {
+        clock->referenced[clock->hand] = 0;
+        clock->hand = (clock->hand + 1) % clock->frame_count;
+    }
+    int frame = clock->hand;
+    clock->hand = (clock->hand + 1) % clock->frame_count;
+    return frame;
+}
+
+static void clock_destroy(ReplacementPolicy *policy) {
+    ClockPolicy *clock = (ClockPolicy *)policy;
+    free(clock->referenced);
+    free(clock);
+}
+
+static ReplacementPolicy *clock_create(int frame_count) {
+    ClockPolicy *clock = calloc(1, sizeof(ClockPolicy));
+    if (clock == NULL) {
+        return NULL;
+    }
+    clock->frame_count = frame_count;
+    clock->referenced = calloc(frame_count, 1);
+    if (clock->referenced == NULL) {
+        clock_destroy(&clock->base);
+        return NULL;
+    }
+    return &clock->base;
+}
+
+// ---------------------------------------------------------------------------
+// LFU: frames grouped into buckets of equal use count, buckets kept in
+// increasing count order; the victim is the least recently used frame of the
+// lowest bucket. A reference moves a frame to the next bucket up, so every
+// operation is O(1).
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    long count;       // Use count shared by every frame in the bucket
+    int lower;        // Bucket with the next smaller count
+    int higher;       // Bucket with the next larger count
+    IndexList frames; // Frames with this count, most recent first
+} LfuBucket;
+
+typedef struct {
+    ReplacementPolicy base;
+    LfuBucket *buckets;  // Bucket pool (at most one bucket per frame)
+    int *free_buckets;   // Stack of unused bucket indices
+    int num_free;
+    int lowest;          // Bucket with the smallest count
+    int *bucket_of;      // Bucket holding each frame
+    int *prev;
+    int *next;
+} LfuPolicy;
+
+static int lfu_new_bucket(LfuPolicy *lfu, long count, int lower, int higher) {
+    int b = lfu->free_buckets[--lfu->num_free];
+    lfu->buckets[b].count = count;
+    lfu->buckets[b].lower = lower;
+    lfu->buckets[b].higher = higher;
+    list_init(&lfu->buckets[b].frames);
+    if (lower != -1) {
+        lfu->buckets[lower].higher = b;
+    } else {
+        lfu->lowest = b;
+    }
+    if (higher != -1) {
+        lfu->buckets[higher].lower = b;
+    }
+    return b;
+}
+
+// Take a frame out of its bucket, releasing the bucket if it empties
+static void lfu_unlink(LfuPolicy *lfu, int frame) {
+    int b = lfu->bucket_of[frame];
+    LfuBucket *bucket = &lfu->buckets[b];
+    list_remove(&bucket->frames, lfu->prev, lfu->next, frame);
+    if (bucket->frames.size == 0) {
+        if (bucket->lower != -1) {
+            lfu->buckets[bucket->lower].higher = bucket->higher;
+        } else {
+            lfu->lowest = bucket->higher;
+        }
+        if (bucket->higher != -1) {
+            lfu->buckets[bucket->higher].lower = bucket->lower;
+        }
+        lfu->free_buckets[lfu->num_free++] = b;
+    }
+    lfu->bucket_of[frame] = -1;
+}
+
+static void lfu_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LfuPolicy *lfu = (LfuPolicy *)policy;
+    (void)page; (void)time;
+    int b = lfu->bucket_of[frame];
+    long count = lfu->buckets[b].count + 1;
+    int higher = lfu->buckets[b].higher;
+
+    int target;
+    if (higher != -1 && lfu->buckets[higher].count == count) {
+        target = higher;
+        lfu_unlink(lfu, frame);
+    } else if (lfu->buckets[b].frames.size == 1) {
+        // Sole member: bump the bucket's count in place
+        lfu->buckets[b].count = count;
+        return;
+    } else {
+        lfu_unlink(lfu, frame);
+        target = lfu_new_bucket(lfu, count, b, higher);
+    }
+    list_push_front(&lfu->buckets[target].frames, lfu->prev, lfu->next, frame);
+    lfu->bucket_of[frame] = target;
+}
+
+static void lfu_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LfuPolicy *lfu = (LfuPolicy *)policy;
+    (void)page; (void)time;
+    int target = lfu->lowest;
+    if (target == -1 || lfu->buckets[target].count != 1) {
+        target = lfu_new_bucket(lfu, 1, -1, lfu->lowest);
+    }
+    list_push_front(&lfu->buckets[target].frames, lfu->prev, lfu->next, frame);
+    lfu->bucket_of[frame] = target;
+}
+
+static int lfu_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    LfuPolicy *lfu = (LfuPolicy *)policy;
+    (void)page; (void)time;
+    int frame = lfu->buckets[lfu->lowest].frames.tail;
+    lfu_unlink(lfu, frame);
+    return frame;
+}
+
+static void lfu_destroy(ReplacementPolicy *policy) {
+    LfuPolicy *lfu = (LfuPolicy *)policy;
+    free(lfu->buckets);
+    free(lfu->free_buckets);
+    free(lfu->bucket_of);
+    free(lfu->prev);
+    free(lfu->next);
+    free(lfu);
+}
+
+static ReplacementPolicy *lfu_create(int frame_count) {
+    LfuPolicy *lfu = calloc(1, sizeof(LfuPolicy));
+    if (lfu == NULL) {
+        return NULL;
+    }
+    // One spare bucket: lfu_access allocates before the old bucket is freed
+    int bucket_count = frame_count + 1;
+    lfu->buckets = malloc(bucket_count * sizeof(LfuBucket));
+    lfu->free_buckets = malloc(bucket_count * sizeof(int));
+    lfu->bucket_of = alloc_indices(frame_count);
+    lfu->prev = alloc_indices(frame_count);
+    lfu->next = alloc_indices(frame_count);
+    if (lfu->buckets == NULL || lfu->free_buckets == NULL || lfu->bucket_of == NULL ||
+        lfu->prev == NULL || lfu->next == NULL) {
+        lfu_destroy(&lfu->base);
+        return NULL;
+    }
+    for (int i = 0; i < bucket_count; i++) {
+        lfu->free_buckets[i] = bucket_count - 1 - i;
+    }
+    lfu->num_free = bucket_count;
+    lfu->lowest = -1;
+    return &lfu->base;
+}
+
+// ---------------------------------------------------------------------------
+// ARC (Megiddo & Modha): resident lists T1 (seen once) and T2 (seen at least
+// twice) plus ghost lists B1/B2 of recently evicted pages. Ghost hits adapt
+// the target size p of T1. Nodes 0..c-1 are the frames; nodes c..2c are
+// ghost entries.
+// ---------------------------------------------------------------------------
+
+enum { ARC_T1, ARC_T2, ARC_B1, ARC_B2, ARC_LISTS };
+
+typedef struct {
+    ReplacementPolicy base;
+    int c;                   // Cache size (frames)
+    int p;                   // Target size of T1
+    IndexList lists[ARC_LISTS];
+    int *prev;
+    int *next;
+    int *node_list;          // List each node is on
+    int64_t *node_page;      // Page held by each node
+    PageMap node_of_page;    // Node holding each page (resident or ghost)
+    int *free_ghosts;        // Stack of unused ghost nodes
+    int num_free_ghosts;
+} ArcPolicy;
+
+static void arc_move(ArcPolicy *arc, int node, int list) {
+    if (arc->node_list[node] != -1) {
+        list_remove(&arc->lists[arc->node_list[node]], arc->prev, arc->next, node);
+    }
+    list_push_front(&arc->lists[list], arc->prev, arc->next, node);
+    arc->node_list[node] = list;
+}
+
+// Forget the least recently used page of a ghost list
+static void arc_drop_ghost(ArcPolicy *arc, int list) {
+    int ghost = arc->lists[list].tail;
+    list_remove(&arc->lists[list], arc->prev, arc->next, ghost);
+    arc->node_list[ghost] = -1;
+    pagemap_remove(&arc->node_of_page, arc->node_page[ghost]);
+    arc->free_ghosts[arc->num_free_ghosts++] = ghost;
+}
+
+// Evict the LRU frame of a resident list, remembering its page in a ghost list
+// (or forgetting it entirely when ghost_list is -1)
+static int arc_evict(ArcPolicy *arc, int list, int ghost_list) {
+    int frame = arc->lists[list].tail;
+    int64_t page = arc->node_page[frame];
+    list_remove(&arc->lists[list], arc->prev, arc->next, frame);
+    arc->node_list[frame] = -1;
+
+    if (ghost_list == -1) {
+        pagemap_remove(&arc->node_of_page, page);
+    } else {
+        int ghost = arc->free_ghosts[--arc->num_free_ghosts];
+        arc->node_page[ghost] = page;
+        pagemap_put(&arc->node_of_page, page, ghost);
+        arc_move(arc, ghost, ghost_list);
+    }
+    return frame;
+}
+
+// ARC's REPLACE subroutine
+static int arc_replace(ArcPolicy *arc, int in_b2) {
+    int t1 = arc->lists[ARC_T1].size;
+    if (t1 > 0 && ((in_b2 && t1 == arc->p) || t1 > arc->p || arc->lists[ARC_T2].size == 0)) {
+        return arc_evict(arc, ARC_T1, ARC_B1);
+    }
+    return arc_evict(arc, ARC_T2, ARC_B2);
+}
+
+static void arc_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    ArcPolicy *arc = (ArcPolicy *)policy;
+    (void)page; (void)time;
+    arc_move(arc, frame, ARC_T2);
+}
+
+static int arc_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    ArcPolicy *arc = (ArcPolicy *)policy;
+    (void)time;
+    int node = (int)pagemap_get(&arc->node_of_page, page, -1);
+    int list = node == -1 ? -1 : arc->node_list[node];
+    int b1 = arc->lists[ARC_B1].size;
+    int b2 = arc->lists[ARC_B2].size;
+
+    if (list == ARC_B1) {
+        int delta = b2 / b1 > 1 ? b2 / b1 : 1;
+        arc->p = arc->p + delta < arc->c ? arc->p + delta : arc->c;
+        return arc_replace(arc, 0);
+    }
+    if (list == ARC_B2) {
+        int delta = b1 / b2 > 1 ? b1 / b2 : 1;
+        arc->p = arc->p - delta > 0 ? arc->p - delta : 0;
+        return arc_replace(arc, 1);
+    }
+
+    // Page not seen recently; memory is full
+    int t1 = arc->lists[ARC_T1].size;
+    if (t1 + b1 == arc->c) {
+        if (t1 < arc->c) {
+            arc_drop_ghost(arc, ARC_B1);
+            return arc_replace(arc, 0);
+        }
+        return arc_evict(arc, ARC_T1, -1);
+    }
+    if (t1 + arc->lists[ARC_T2].size + b1 + b2 >= 2 * arc->c) {
+        arc_drop_ghost(arc, ARC_B2);
+    }
+    return arc_replace(arc, 0);
+}
+
+static void arc_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    ArcPolicy *arc = (ArcPolicy *)policy;
+    (void)time;
+    int ghost = (int)pagemap_get(&arc->node_of_page, page, -1);
+    int list = ARC_T1;
+    if (ghost != -1) {
+        // Ghost hit: the page goes straight to T2
+        list_remove(&arc->lists[arc->node_list[ghost]], arc->prev, arc->next, ghost);
+        arc->node_list[ghost] = -1;
+        arc->free_ghosts[arc->num_free_ghosts++] = ghost;
+        list = ARC_T2;
+    }
+    arc->node_page[frame] = page;
+    pagemap_put(&arc->node_of_page, page, frame);
+    arc_move(arc, frame, list);
+}
+
+static void arc_destroy(ReplacementPolicy *policy) {
+    ArcPolicy *arc = (ArcPolicy *)policy;
+    free(arc->prev);
+    free(arc->next);
+    free(arc->node_list);
+    free(arc->node_page);
+    pagemap_destroy(&arc->node_of_page);
+    free(arc->free_ghosts);
+    free(arc);
+}
+
+static ReplacementPolicy *arc_create(int frame_count) {
+    ArcPolicy *arc = calloc(1, sizeof(ArcPolicy));
+    if (arc == NULL) {
+        return NULL;
+    }
+    // Ghosts never exceed c, plus one while a ghost hit is being filled
+    int ghost_count = frame_count + 1;
+    int node_count = frame_count + ghost_count;
+    arc->c = frame_count;
+    arc->p = 0;
+    for (int i = 0; i < ARC_LISTS; i++) {
+        list_init(&arc->lists[i]);
+    }
+    arc->prev = alloc_indices(node_count);
+    arc->next = alloc_indices(node_count);
+    arc->node_list = alloc_indices(node_count);
+    arc->node_page = malloc(node_count * sizeof(int64_t));
+    arc->free_ghosts = malloc(ghost_count * sizeof(int));
+    // Sized for every node at once, so puts never need to grow the map
+    int map_status = pagemap_init(&arc->node_of_page, node_count);
+    if (arc->prev == NULL || arc->next == NULL || arc->node_list == NULL ||
+        arc->node_page == NULL || map_status != 0 || arc->free_ghosts == NULL) {
+        arc_destroy(&arc->base);
+        return NULL;
+    }
+    for (int i = 0; i < ghost_count; i++) {
+        arc->free_ghosts[i] = node_count - 1 - i;
+    }
+    arc->num_free_ghosts = ghost_count;
+    return &arc->base;
+}
+
+// ---------------------------------------------------------------------------
+// OPT (Belady): evict the frame whose page is next used furthest in the
+// future. Resident frames sit in a max-heap keyed by next-use time.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    ReplacementPolicy base;
+    const long *next_use;   // Next reference index for each reference
+    int *heap;              // Frames, furthest next use at the root
+    int *position;          // Heap index of each frame
+    unsigned long *key;     // Next use of each frame (never = largest)
+    int size;
+} OptPolicy;
+
+static void opt_swap(OptPolicy *opt, int i, int j) {
+    int a = opt->heap[i];
+    int b = opt->heap[j];
+    opt->heap[i] = b;
+    opt->heap[j] = a;
+    opt->position[b] = i;
+    opt->position[a] = j;
+}
+
+static void opt_sift(OptPolicy *opt, int i) {
+    while (i > 0 && opt->key[opt->heap[(i - 1) / 2]] < opt->key[opt->heap[i]]) {
+        opt_swap(opt, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    while (1) {
+        int largest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < opt->size && opt->key[opt->heap[left]] > opt->key[opt->heap[largest]]) {
+            largest = left;
+        }
+        if (right < opt->size && opt->key[opt->heap[right]] > opt->key[opt->heap[largest]]) {
+            largest = right;
+        }
+        if (largest == i) {
+            break;
+        }
+        opt_swap(opt, i, largest);
+        i = largest;
+    }
+}
+
+static void opt_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    OptPolicy *opt = (OptPolicy *)policy;
+    (void)page;
+    // NEVER_USED_AGAIN (-1) becomes the largest unsigned key
+    opt->key[frame] = (unsigned long)opt->next_use[time];
+    opt_sift(opt, opt->position[frame]);
+}
+
+static void opt_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    OptPolicy *opt = (OptPolicy *)policy;
+    (void)page;
+    opt->key[frame] = (unsigned long)opt->next_use[time];
+    opt->heap[opt->size] = frame;
+    opt->position[frame] = opt->size;
+    opt->size++;
+    opt_sift(opt, opt->size - 1);
+}
+
+static int opt_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    OptPolicy *opt = (OptPolicy *)policy;
+    (void)page; (void)time;
+    int frame = opt->heap[0];
+    opt->size--;
+    if (opt->size > 0) {
+        opt_swap(opt, 0, opt->size);
+        opt_sift(opt, 0);
+    }
+    opt->position[frame] = -1;
+    return frame;
+}
+
+static void opt_destroy(ReplacementPolicy *policy) {
+    OptPolicy *opt = (OptPolicy *)policy;
+    free(opt->heap);
+    free(opt->position);
+    free(opt->key);
+    free(opt);
+}
+
+static ReplacementPolicy *opt_create(int frame_count, const long *next_use) {
+    if (next_use == NULL) {
+        return NULL;
+    }
+    OptPolicy *opt = calloc(1, sizeof(OptPolicy));
+    if (opt == NULL) {
+        return NULL;
+    }
+    opt->next_use = next_use;
+    opt->heap = alloc_indices(frame_count);
+    opt->position = alloc_indices(frame_count);
+    opt->key = calloc(frame_count, sizeof(unsigned long));
+    if (opt->heap == NULL || opt->position == NULL || opt->key == NULL) {
+        opt_destroy(&opt->base);
+        return NULL;
+    }
+    return &opt->base;
+}
+
+// ---------------------------------------------------------------------------
+// WS / PFF: per-process LRU lists over frames. Each process has its own
+// reference clock, so windows and intervals are measured in the process's
+// own references however the trace interleaves them.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    ReplacementPolicy base;
+    bool pff;              // PFF instead of working set
+    int asid_shift;
+    long window;           // WS window or PFF interval
+    int *prev;
+    int *next;
+    int *owner;            // Process holding each frame
+    long *last_use;        // Owner's clock at each frame's last reference
+    long *last_time;       // Trace time of each frame's last reference
+    IndexList *lists;      // Frames of each process, most recent first
+    long *clock;           // References made by each process
+    long *last_fault;      // Each process's clock at its last fault
+    int process_count;     // Processes seen (ASIDs below this are set up)
+    int process_capacity;  // Entries allocated in the per-process arrays
+} LocalPolicy;
+
+// Process of a page
+static inline int local_process(const LocalPolicy *local, int64_t page) {
+    return (int)(page >> local->asid_shift);
+}
+
+static int local_add_processes(ReplacementPolicy *policy, int count) {
+    LocalPolicy *local = (LocalPolicy *)policy;
+    if (count > local->process_capacity) {
+        int capacity = local->process_capacity;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        // Keep each array that did grow, so local_destroy frees it either way
+        IndexList *lists = realloc(local->lists, capacity * sizeof(IndexList));
+        if (lists != NULL) {
+            local->lists = lists;
+        }
+        long *clock = realloc(local->clock, capacity * sizeof(long));
+        if (clock != NULL) {
+            local->clock = clock;
+        }
+        long *last_fault = realloc(local->last_fault, capacity * sizeof(long));
+        if (last_fault != NULL) {
+            local->last_fault = last_fault;
+        }
+        if (lists == NULL || clock == NULL || last_fault == NULL) {
+            return -1;
+        }
+        local->process_capacity = capacity;
+    }
+    while (local->process_count < count) {
+        local->clock[local->process_count] = 0;
+        local->last_fault[local->process_count] = 0;
+        list_init(&local->lists[local->process_count++]);
+    }
+    return 0;
+}
+
+static void local_touch(LocalPolicy *local, int frame, int process, long time) {
+    local->clock[process]++;
+    local->last_use[frame] = local->clock[process];
+    local->last_time[frame] = time;
+}
+
+static void local_access(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LocalPolicy *local = (LocalPolicy *)policy;
+    (void)page;
+    int process = local->owner[frame];
+    IndexList *list = &local->lists[process];
+    if (list->head != frame) {
+        list_remove(list, local->prev, local->next, frame);
+        list_push_front(list, local->prev, local->next, frame);
+    }
+    local_touch(local, frame, process, time);
+}
+
+static void local_fill(ReplacementPolicy *policy, int frame, int64_t page, long time) {
+    LocalPolicy *local = (LocalPolicy *)policy;
+    int process = local_process(local, page);
+    local->owner[frame] = process;
+    list_push_front(&local->lists[process], local->prev, local->next, frame);
+    local_touch(local, frame, process, time);
+    local->last_fault[process] = local->clock[process];
+}
+
+// Least recently used frame (by trace time) among the LRU pages of every
+// process except `skip`; with `window` > 0 only pages idle for more than
+// `window` of their owner's references qualify. Returns -1 if none does.
+static int local_oldest(const LocalPolicy *local, int skip, long window) {
+    int oldest = -1;
+    for (int process = 0; process < local->process_count; process++) {
+        int frame = local->lists[process].tail;
+        if (process == skip || local->lists[process].size == 0 ||
+            (window > 0 && local->clock[process] - local->last_use[frame] <= window)) {
+            continue;
+        }
+        if (oldest == -1 || local->last_time[frame] < local->last_time[oldest]) {
+            oldest = frame;
+        }
+    }
+    return oldest;
+}
+
+static int local_victim(ReplacementPolicy *policy, int64_t page, long time) {
+    LocalPolicy *local = (LocalPolicy *)policy;
+    (void)time;
+    int process = local_process(local, page);
+    bool has_frames = local->lists[process].size > 0;
+
+    int frame = -1;
+    if (!local->pff) {
+        frame = local_oldest(local, -1, local->window);
+        if (frame == -1) {
+            // Every page is in a working set: shrink the largest process
+            int largest = process;
+            for (int other = 0; other < local->process_count; other++) {
+                if (local->lists[other].size > local->lists[largest].size) {
+                    largest = other;
+                }
+            }
+            frame = local->lists[largest].tail;
+        }
+    } else if (!has_frames || local->clock[process] - local->last_fault[process] <= local->window) {
+        // Faulting often: grow at another process's expense
+        frame = local_oldest(local, process, 0);
+    } else {
+        frame = local->lists[process].tail;
+    }
+    if (frame == -1) {
+        frame = local_oldest(local, -1, 0);
+    }
+    list_remove(&local->lists[local->owner[frame]], local->prev, local->next, frame);
+    return frame;
+}
+
+static void local_destroy(ReplacementPolicy *policy) {
+    LocalPolicy *local = (LocalPolicy *)policy;
+    free(local->prev);
+    free(local->next);
+    free(local->owner);
+    free(local->last_use);
+    free(local->last_time);
+    free(local->lists);
+    free(local->clock);
+    free(local->last_fault);
+    free(local);
+}
+
+static ReplacementPolicy *local_create(int frame_count, bool pff, int asid_shift, long window) {
+    LocalPolicy *local = calloc(1, sizeof(LocalPolicy));
+    if (local == NULL) {
+        return NULL;
+    }
+    local->pff = pff;
+    local->asid_shift = asid_shift;
+    local->window = window;
+    local->prev = alloc_indices(frame_count);
+    local->next = alloc_indices(frame_count);
+    local->owner = calloc(frame_count, sizeof(int));
+    local->last_use = calloc(frame_count, sizeof(long));
+    local->last_time = calloc(frame_count, sizeof(long));
+    // Per-process arrays start with process 0 and grow as ASIDs appear
+    local->process_capacity = 1;
+    local->lists = calloc(1, sizeof(IndexList));
+    local->clock = calloc(1, sizeof(long));
+    local->last_fault = calloc(1, sizeof(long));
+    if (local->prev == NULL || local->next == NULL || local->owner == NULL ||
+        local->last_use == NULL || local->last_time == NULL || local->lists == NULL ||
+        local->clock == NULL || local->last_fault == NULL) {
+        local_destroy(&local->base);
+        return NULL;
+    }
+    local_add_processes(&local->base, 1);
+    return &local->base;
+}
+
+long *policy_next_use(const int64_t *pages, long count) {
+    long *next_use = malloc((count > 0 ? count : 1) * sizeof(long));
+    PageMap last_seen;    // Most recent index (scanning backwards) of each page
+    if (next_use == NULL || pagemap_init(&last_seen, 0) != 0) {
+        free(next_use);
+        return NULL;
+    }
+    for (long i = count - 1; i >= 0; i--) {
+        next_use[i] = pagemap_get(&last_seen, pages[i], NEVER_USED_AGAIN);
+        if (pagemap_put(&last_seen, pages[i], i) != 0) {
+            free(next_use);
+            pagemap_destroy(&last_seen);
+            return NULL;
+        }
+    }
+    pagemap_destroy(&last_seen);
+    return next_use;
+}
+
+// ---------------------------------------------------------------------------
+
+ReplacementPolicy *policy_create(const char *name, int frame_count, const PolicyParams *params) {
+    ReplacementPolicy *policy = NULL;
+    if (strcmp(name, "fifo") == 0) {
+        policy = fifo_create(frame_count);
+        if (policy != NULL) {
+            policy->access = fifo_access;
+            policy->fill = fifo_fill;
+            policy->victim = fifo_victim;
+            policy->destroy = fifo_destroy;
+        }
+    } else if (strcmp(name, "lru") == 0) {
+        policy = lru_create(frame_count);
+        if (policy != NULL) {
+            policy->access = lru_access;
+            policy->fill = lru_fill;
+            policy->victim = lru_victim;
+            policy->destroy = lru_destroy;
+        }
+    } else if (strcmp(name, "clock") == 0) {
+        policy = clock_create(frame_count);
+        if (policy != NULL) {
+            policy->access = clock_access;
+            policy->fill = clock_access;   // A new page starts with its bit set
+            policy->victim = clock_victim;
+            policy->destroy = clock_destroy;
+        }
+    } else if (strcmp(name, "lfu") == 0) {
+        policy = lfu_create(frame_count);
+        if (policy != NULL) {
+            policy->access = lfu_access;
+            policy->fill = lfu_fill;
+            policy->victim = lfu_victim;
+            policy->destroy = lfu_destroy;
+        }
+    } else if (strcmp(name, "arc") == 0) {
+        policy = arc_create(frame_count);
+        if (policy != NULL) {
+            policy->access = arc_access;
+            policy->fill = arc_fill;
+            policy->victim = arc_victim;
+            policy->destroy = arc_destroy;
+        }
+    } else if (strcmp(name, "opt") == 0) {
+        policy = opt_create(frame_count, params->next_use);
+        if (policy != NULL) {
+            policy->access = opt_access;
+            policy->fill = opt_fill;
+            policy->victim = opt_victim;
+            policy->destroy = opt_destroy;
+        }
+    } else if (strcmp(name, "ws") == 0 || strcmp(name, "pff") == 0) {
+        bool pff = strcmp(name, "pff") == 0;
+        policy = local_create(frame_count, pff, params->asid_shift,
+                              pff ? params->pff_interval : params->ws_window);
+        if (policy != NULL) {
+            policy->access = local_access;
+            policy->fill = local_fill;
+            policy->victim = local_victim;
+            policy->add_processes = local_add_processes;
+            policy->destroy = local_destroy;
+        }
+    }
+    if (policy != NULL) {
+        policy->name = name;
+    }
+    return policy;
+}
+
+void policy_destroy(ReplacementPolicy *policy) {
+    if (policy != NULL) {
+        policy->destroy(policy);
+    }
+}
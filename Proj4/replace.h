@@ -0,0 +1,71 @@
+/**
+ * Project 4 - Page replacement policies
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Every policy implements the same interface and tracks frames only:
+ * - access: a resident page was referenced (TLB or page table hit)
+ * - fill:   a page was just loaded into a frame
+ * - victim: memory is full; pick the frame to evict and forget it
+ *
+ * Per-fault cost: FIFO, LRU, LFU and ARC are O(1), Clock is amortized
+ * O(1), and OPT is O(log frames) using a max-heap of next-use times.
+ *
+ * In multi-process runs page numbers carry the process's ASID above bit
+ * `asid_shift`. The policies above replace globally, ignoring it; ws and
+ * pff keep an LRU list per process (set up through add_processes before a
+ * process's first page arrives) and decide whose frame to take:
+ * - ws:  evict the stalest page that has fallen out of its process's
+ *        working set (not referenced in the last ws_window references of
+ *        that process); if none has, the process holding the most frames
+ *        gives up its LRU page
+ * - pff: a process faulting more often than once per pff_interval of its
+ *        references grows by taking the globally least recently used page
+ *        of another process; otherwise it replaces its own LRU page
+ * Their per-fault cost is O(processes).
+ */
+#ifndef REPLACE_H
+#define REPLACE_H
+
+#include <stdint.h>
+
+#define POLICY_NAMES "fifo|lru|clock|lfu|arc|opt|ws|pff"
+#define NEVER_USED_AGAIN (-1L)  // next_use value for a last reference
+#define WS_WINDOW 1000          // Default working-set window (references)
+#define PFF_INTERVAL 100        // Default PFF fault interval threshold (references)
+
+typedef struct ReplacementPolicy ReplacementPolicy;
+
+// Common policy interface (each policy embeds this as its first member)
+struct ReplacementPolicy {
+    const char *name;
+    void (*access)(ReplacementPolicy *policy, int frame, int64_t page, long time);
+    void (*fill)(ReplacementPolicy *policy, int frame, int64_t page, long time);
+    int (*victim)(ReplacementPolicy *policy, int64_t page, long time);
+    // Set up state for the processes below `count`; returns 0 on success,
+    // -1 on allocation failure (NULL for policies that replace globally)
+    int (*add_processes)(ReplacementPolicy *policy, int count);
+    void (*destroy)(ReplacementPolicy *policy);
+};
+
+// Policy parameters
+typedef struct {
+    const long *next_use;   // Next-use indices (required by "opt")
+    int asid_shift;         // Page numbers hold the ASID from this bit up
+    long ws_window;         // Working-set window of "ws"
+    long pff_interval;      // Fault interval threshold of "pff"
+} PolicyParams;
+
+// Create a policy by name; returns NULL for an unknown name, for "opt" without
+// next_use, or on allocation failure
+ReplacementPolicy *policy_create(const char *name, int frame_count, const PolicyParams *params);
+
+// Free a policy
+void policy_destroy(ReplacementPolicy *policy);
+
+// Compute, for each reference, the index of the next reference to the same page
+// (or NEVER_USED_AGAIN) in one backward pass; returns NULL on allocation failure
+long *policy_next_use(const int64_t *pages, long count);
+
+#endif
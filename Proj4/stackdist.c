@@ -0,0 +1,151 @@
+/**
+ * Project 4 - LRU stack distance analysis
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "stackdist.h"
+
+#define MIN_SLOTS 4096
+
+static void tree_add(StackDistance *sd, int slot, int delta) {
+    for (int i = slot + 1; i <= sd->capacity; i += i & -i) {
+        sd->tree[i] += delta;
+    }
+}
+
+// Number of marked slots in [0, slot]
+static int tree_prefix(const StackDistance *sd, int slot) {
+    int sum = 0;
+    for (int i = slot + 1; i > 0; i -= i & -i) {
+        sum += sd->tree[i];
+    }
+    return sum;
+}
+
+// Renumber the marked slots 0..k-1 (keeping their order), doubling the tree
+// if more than half of it would still be in use, and rebuild it
+static int compact(StackDistance *sd) {
+    int k = 0;
+    for (int slot = 0; slot < sd->next_slot; slot++) {
+        int64_t page = sd->slot_page[slot];
+        if (page != -1) {
+            sd->slot_page[slot] = -1;
+            sd->slot_page[k] = page;
+            pagemap_put(&sd->last_slot, page, k);
+            k++;
+        }
+    }
+
+    if (k > sd->capacity / 2) {
+        int capacity = sd->capacity * 2;
+        int *tree = realloc(sd->tree, (capacity + 1) * sizeof(int));
+        if (tree != NULL) {
+            sd->tree = tree;
+        }
+        int64_t *slot_page = realloc(sd->slot_page, capacity * sizeof(int64_t));
+        if (slot_page != NULL) {
+            sd->slot_page = slot_page;
+        }
+        if (tree == NULL || slot_page == NULL) {
+            return -1;
+        }
+        for (int i = sd->capacity; i < capacity; i++) {
+            sd->slot_page[i] = -1;
+        }
+        sd->capacity = capacity;
+    }
+
+    // Linear-time Fenwick build over the k marked slots
+    memset(sd->tree, 0, (sd->capacity + 1) * sizeof(int));
+    for (int i = 1; i <= sd->capacity; i++) {
+        if (i <= k) {
+            sd->tree[i] += 1;
+        }
+        int parent = i + (i & -i);
+        if (parent <= sd->capacity) {
+            sd->tree[parent] += sd->tree[i];
+        }
+    }
+    sd->next_slot = k;
+    return 0;
+}
+
+int stackdist_init(StackDistance *sd, int max_distance) {
+    memset(sd, 0, sizeof(*sd));
+    sd->max_distance = max_distance;
+    sd->capacity = MIN_SLOTS;
+    sd->tree = calloc(sd->capacity + 1, sizeof(int));
+    sd->slot_page = malloc(sd->capacity * sizeof(int64_t));
+    sd->histogram = calloc(max_distance + 1, sizeof(long));
+    if (sd->tree == NULL || sd->slot_page == NULL || sd->histogram == NULL ||
+        pagemap_init(&sd->last_slot, MIN_SLOTS / 2) != 0) {
+        stackdist_destroy(sd);
+        return -1;
+    }
+    for (int i = 0; i < sd->capacity; i++) {
+        sd->slot_page[i] = -1;
+    }
+    return 0;
+}
+
+void stackdist_destroy(StackDistance *sd) {
+    free(sd->tree);
+    free(sd->slot_page);
+    free(sd->histogram);
+    pagemap_destroy(&sd->last_slot);
+    sd->tree = NULL;
+    sd->slot_page = NULL;
+    sd->histogram = NULL;
+}
+
+long stackdist_access(StackDistance *sd, int64_t page) {
+    sd->references++;
+    if (sd->next_slot == sd->capacity && compact(sd) != 0) {
+        return -1;
+    }
+
+    int last = (int)pagemap_get(&sd->last_slot, page, -1);
+    long distance = 0;
+    if (last == -1) {
+        sd->cold_misses++;
+    } else {
+        // Distinct pages referenced after the previous use, plus this page
+        distance = tree_prefix(sd, sd->next_slot - 1) - tree_prefix(sd, last) + 1;
+        if (distance <= sd->max_distance) {
+            sd->histogram[distance]++;
+        } else {
+            sd->far_reuses++;
+        }
+        tree_add(sd, last, -1);
+        sd->slot_page[last] = -1;
+    }
+
+    int slot = sd->next_slot++;
+    tree_add(sd, slot, 1);
+    sd->slot_page[slot] = page;
+    return pagemap_put(&sd->last_slot, page, slot) == 0 ? distance : -1;
+}
+
+int stackdist_reference(StackDistance *sd, int64_t page) {
+    return stackdist_access(sd, page) < 0 ? -1 : 0;
+}
+
+void stackdist_forget(StackDistance *sd, int64_t page) {
+    int last = (int)pagemap_get(&sd->last_slot, page, -1);
+    if (last != -1) {
+        tree_add(sd, last, -1);
+        sd->slot_page[last] = -1;
+        pagemap_remove(&sd->last_slot, page);
+    }
+}
+
+long stackdist_faults(const StackDistance *sd, int frames) {
+    long faults = sd->cold_misses + sd->far_reuses;
+    for (int d = frames + 1; d <= sd->max_distance; d++) {
+        faults += sd->histogram[d];
+    }
+    return faults;
+}
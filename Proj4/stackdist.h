@@ -0,0 +1,61 @@
+/**
+ * Project 4 - LRU stack distance analysis
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * LRU is a stack algorithm: a reference hits in memory of F frames exactly
+ * when its stack distance (number of distinct pages touched since the
+ * previous reference to the same page, plus one) is at most F. One pass that
+ * histograms stack distances therefore gives the LRU fault count for every
+ * frame count at once.
+ *
+ * Distances come from a Fenwick tree over reference times in which only
+ * each page's most recent reference is marked. Times are renumbered when
+ * the tree fills (and the tree doubles when most slots are live), so memory
+ * stays proportional to the number of distinct pages, not the trace length.
+ * Pages are tracked in a hash map, so any page number width works.
+ *
+ * Pages can also be forgotten, which lets a sampler (see profile.h) keep
+ * only a bounded subset of the pages in the tree.
+ */
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <stdint.h>
+#include "pagemap.h"
+
+// Stack distance state
+typedef struct {
+    int max_distance;    // Largest distance histogrammed exactly
+    int capacity;        // Number of time slots in the tree
+    int *tree;           // Fenwick tree of marked time slots (1-based)
+    PageMap last_slot;   // Slot of each page's latest reference
+    int64_t *slot_page;  // Page marked at each slot, or -1
+    int next_slot;       // Slot for the next reference
+    long *histogram;     // histogram[d] = references with stack distance d
+    long far_reuses;     // Re-references with distance > max_distance
+    long cold_misses;    // First references to a page
+    long references;
+} StackDistance;
+
+// Set up to report fault counts for up to max_distance frames; returns 0 on success
+int stackdist_init(StackDistance *sd, int max_distance);
+
+// Release the tree and histogram
+void stackdist_destroy(StackDistance *sd);
+
+// Record one reference; returns 0 on success, -1 on allocation failure
+int stackdist_reference(StackDistance *sd, int64_t page);
+
+// Record one reference and return its stack distance (0 for a first
+// reference), or -1 on allocation failure
+long stackdist_access(StackDistance *sd, int64_t page);
+
+// Stop tracking a page (its next reference counts as a first reference)
+void stackdist_forget(StackDistance *sd, int64_t page);
+
+// LRU page faults with the given number of frames (at most max_distance)
+long stackdist_faults(const StackDistance *sd, int frames);
+
+#endif
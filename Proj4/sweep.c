@@ -0,0 +1,231 @@
+/**
+ * Project 4 - Parallel configuration sweep
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "sweep.h"
+
+int *sweep_parse_ints(const char *spec, int *count) {
+    int capacity = 16;
+    int n = 0;
+    int *values = malloc(capacity * sizeof(int));
+    const char *p = spec;
+
+    while (values != NULL) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        long step = 1;
+        if (end == p) {
+            break;
+        }
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1) {
+                break;
+            }
+            p = end;
+            if (*p == ':') {
+                step = strtol(p + 1, &end, 10);
+                if (end == p + 1 || step <= 0) {
+                    break;
+                }
+                p = end;
+            }
+        }
+        // Every range holds at least one value, and all of them fit in an int
+        if (last < first || first < INT_MIN || last > INT_MAX || step > INT_MAX) {
+            break;
+        }
+        for (long long v = first; v <= last; v += step) {
+            if (n == capacity) {
+                capacity *= 2;
+                int *grown = realloc(values, capacity * sizeof(int));
+                if (grown == NULL) {
+                    free(values);
+                    return NULL;
+                }
+                values = grown;
+            }
+            values[n++] = (int)v;
+        }
+        if (*p == '\0') {
+            *count = n;
+            return values;
+        }
+        if (*p != ',') {
+            break;
+        }
+        p++;
+    }
+    free(values);
+    return NULL;
+}
+
+char **sweep_parse_names(const char *spec, int *count) {
+    char *copy = strdup(spec);
+    int n = 1;
+    for (const char *p = spec; *p; p++) {
+        n += (*p == ',');
+    }
+    char **names = malloc((n + 1) * sizeof(char *));
+    if (copy == NULL || names == NULL) {
+        free(copy);
+        free(names);
+        return NULL;
+    }
+
+    // names[0] owns the copy
+    int i = 0;
+    char *saveptr;
+    for (char *name = strtok_r(copy, ",", &saveptr); name != NULL; name = strtok_r(NULL, ",", &saveptr)) {
+        names[i++] = name;
+    }
+    if (i == 0) {
+        free(copy);
+        free(names);
+        return NULL;
+    }
+    names[i] = NULL;
+    *count = i;
+    return names;
+}
+
+void sweep_free_names(char **names) {
+    if (names != NULL) {
+        free(names[0]);
+        free(names);
+    }
+}
+
+// Configuration for one job
+static VmmConfig job_config(const VmmConfig *base, const SweepJob *job) {
+    VmmConfig config = *base;
+    config.frame_count = job->frame_count;
+    config.policy = job->policy;
+    config.tlb_size = job->tlb_size;
+    return config;
+}
+
+// Shared state of the worker pool
+typedef struct {
+    const VmmConfig *base;
+    const uint64_t *addresses;
+    const uint16_t *asids;     // NULL for a single process
+    long count;
+    SweepJob *jobs;
+    int num_jobs;
+    atomic_int next_job;   // Next job to hand out
+    atomic_int failed;
+} SweepPool;
+
+static void *sweep_worker(void *arg) {
+    SweepPool *pool = (SweepPool *)arg;
+    while (1) {
+        int j = atomic_fetch_add(&pool->next_job, 1);
+        if (j >= pool->num_jobs) {
+            break;
+        }
+
+        SweepJob *job = &pool->jobs[j];
+        VmmConfig config = job_config(pool->base, job);
+        Vmm *vm = vmm_create(&config, NULL);
+        if (vm == NULL) {
+            atomic_store(&pool->failed, 1);
+            continue;
+        }
+        signed char value;
+        for (long i = 0; i < pool->count; i++) {
+            uint16_t asid = pool->asids != NULL ? pool->asids[i] : 0;
+            vmm_access_asid(vm, asid, pool->addresses[i], false, &value);
+            if (vm->failed) {
+                atomic_store(&pool->failed, 1);
+                break;
+            }
+        }
+        job->references = vm->references;
+        job->page_faults = vm->page_faults;
+        job->tlb_hits = vm->tlb_hits;
+        job->eat_ns = vm->references > 0 ? vm->latency.total_ns / vm->references : 0.0;
+        job->p99_ns = latency_percentile(&vm->latency, 0.99);
+        vmm_destroy(vm);
+    }
+    return NULL;
+}
+
+int sweep_run(const VmmConfig *base, const uint64_t *addresses, const uint16_t *asids, long count,
+              SweepJob *jobs, int num_jobs, int threads) {
+    // Check every configuration up front so errors are reported once
+    for (int j = 0; j < num_jobs; j++) {
+        VmmConfig config = job_config(base, &jobs[j]);
+        Vmm *vm = vmm_create(&config, NULL);
+        if (vm == NULL) {
+            return -1;
+        }
+        bool asids_ok = asids == NULL || vmm_asids_ok(vm);
+        if (!asids_ok) {
+            fprintf(stderr, "Error: ASIDs need page numbers of at most %d bits (these have %d)\n",
+                    MAX_ASID_PAGE_BITS, vm->vpn_bits);
+        }
+        vmm_destroy(vm);
+        if (!asids_ok) {
+            return -1;
+        }
+    }
+
+    SweepPool pool;
+    pool.base = base;
+    pool.addresses = addresses;
+    pool.asids = asids;
+    pool.count = count;
+    pool.jobs = jobs;
+    pool.num_jobs = num_jobs;
+    atomic_init(&pool.next_job, 0);
+    atomic_init(&pool.failed, 0);
+
+    if (threads > num_jobs) {
+        threads = num_jobs;
+    }
+    pthread_t *workers = malloc(threads * sizeof(pthread_t));
+    if (workers == NULL) {
+        return -1;
+    }
+    int started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&workers[started], NULL, sweep_worker, &pool) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        // Could not start any thread: run the jobs on this one
+        sweep_worker(&pool);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    free(workers);
+    return atomic_load(&pool.failed) ? -1 : 0;
+}
+
+void sweep_write_csv(FILE *out, const VmmConfig *base, const SweepJob *jobs, int num_jobs) {
+    fprintf(out, "frames,policy,tlb_size,tlb_ways,tlb_policy,l2_tlb_size,"
+                 "references,page_faults,page_fault_rate,tlb_hits,tlb_hit_rate,eat_ns,p99_ns\n");
+    for (int j = 0; j < num_jobs; j++) {
+        const SweepJob *job = &jobs[j];
+        double references = job->references > 0 ? (double)job->references : 1.0;
+        fprintf(out, "%d,%s,%d,%d,%s,%d,%ld,%ld,%.6f,%ld,%.6f,%.2f,%.2f\n",
+                job->frame_count, job->policy, job->tlb_size,
+                base->tlb_ways == 0 ? job->tlb_size : base->tlb_ways, base->tlb_policy,
+                base->l2_tlb_size, job->references, job->page_faults,
+                job->page_faults / references, job->tlb_hits, job->tlb_hits / references,
+                job->eat_ns, job->p99_ns);
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * Project 4 - Parallel configuration sweep
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Simulates a grid of configurations (frame counts x TLB sizes x
+ * replacement policies) over one trace (with its ASIDs, if any) that is
+ * loaded once and shared read-only. Each job gets its own statistics-only
+ * Vmm, so workers share nothing but the trace and a job counter.
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "vmm.h"
+
+// One point of the grid and its results
+typedef struct {
+    int frame_count;
+    const char *policy;
+    int tlb_size;
+    long references;
+    long page_faults;
+    long tlb_hits;
+    double eat_ns;         // Effective (mean simulated) access time
+    double p99_ns;         // 99th percentile reference latency
+} SweepJob;
+
+// Parse a list of integers such as "1-256", "8,16,32" or "1-64:4,128"
+// (a:b means every b-th value); returns a malloc'd array, or NULL if invalid
+// (including reversed ranges and values that do not fit in an int)
+int *sweep_parse_ints(const char *spec, int *count);
+
+// Split a comma-separated list of names; returns a malloc'd array of
+// pointers into a malloc'd copy (freed with sweep_free_names) or NULL
+char **sweep_parse_names(const char *spec, int *count);
+void sweep_free_names(char **names);
+
+// Run every job on a pool of threads (asids may be NULL); returns 0 on success, -1 if a job's
+// configuration is invalid (reported on stderr) or threads can't start
+int sweep_run(const VmmConfig *base, const uint64_t *addresses, const uint16_t *asids, long count,
+              SweepJob *jobs, int num_jobs, int threads);
+
+// Write the results as CSV with a header line
+void sweep_write_csv(FILE *out, const VmmConfig *base, const SweepJob *jobs, int num_jobs);
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * Project 4 - Translation lookaside buffer
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "tlb.h"
+
+static int is_power_of_two(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+int tlb_init(Tlb *tlb, int size, int ways, TlbPolicy policy) {
+    memset(tlb, 0, sizeof(*tlb));
+    if (ways == 0) {
+        ways = size;    // Fully associative
+    }
+    if (size <= 0 || ways <= 0 || size % ways != 0 || !is_power_of_two(size / ways)) {
+        return -1;
+    }
+    if (policy == TLB_PLRU && !is_power_of_two(ways)) {
+        return -1;
+    }
+
+    tlb->size = size;
+    tlb->ways = ways;
+    tlb->sets = size / ways;
+    tlb->stride = (ways + 7) & ~7;
+    tlb->policy = policy;
+    tlb->random_state = 2463534242u;
+
+    size_t entries = (size_t)tlb->sets * tlb->stride;
+    size_t page_bytes = (entries * sizeof(int64_t) + 31) & ~(size_t)31;
+    size_t frame_bytes = (entries * sizeof(int32_t) + 31) & ~(size_t)31;
+    tlb->pages = aligned_alloc(32, page_bytes);
+    tlb->frames = aligned_alloc(32, frame_bytes);
+    tlb->fifo_next = calloc(tlb->sets, sizeof(int));
+    tlb->last_used = calloc(entries, sizeof(uint64_t));
+    tlb->plru_bits = calloc((size_t)tlb->sets * ways, 1);
+    if (tlb->pages == NULL || tlb->frames == NULL || tlb->fifo_next == NULL ||
+        tlb->last_used == NULL || tlb->plru_bits == NULL) {
+        tlb_destroy(tlb);
+        return -1;
+    }
+
+    for (size_t i = 0; i < entries; i++) {
+        tlb->pages[i] = TLB_INVALID;
+        tlb->frames[i] = -1;
+    }
+    return 0;
+}
+
+void tlb_destroy(Tlb *tlb) {
+    free(tlb->pages);
+    free(tlb->frames);
+    free(tlb->fifo_next);
+    free(tlb->last_used);
+    free(tlb->plru_bits);
+    tlb->pages = NULL;
+    tlb->frames = NULL;
+    tlb->fifo_next = NULL;
+    tlb->last_used = NULL;
+    tlb->plru_bits = NULL;
+}
+
+int tlb_policy_from_name(const char *name) {
+    if (strcmp(name, "fifo") == 0) {
+        return TLB_FIFO;
+    } else if (strcmp(name, "lru") == 0) {
+        return TLB_LRU;
+    } else if (strcmp(name, "random") == 0) {
+        return TLB_RANDOM;
+    } else if (strcmp(name, "plru") == 0) {
+        return TLB_PLRU;
+    }
+    return -1;
+}
+
+void tlb_touch(Tlb *tlb, int index) {
+    if (tlb->policy == TLB_LRU) {
+        tlb->last_used[index] = ++tlb->clock;
+    } else if (tlb->policy == TLB_PLRU) {
+        // Point every node on the path away from the used way
+        int set = index / tlb->stride;
+        int way = index % tlb->stride;
+        uint8_t *bits = tlb->plru_bits + (size_t)set * tlb->ways;
+        int node = 0;
+        for (int span = tlb->ways / 2; span > 0; span /= 2) {
+            int right = (way & span) != 0;
+            bits[node] = !right;
+            node = 2 * node + 1 + right;
+        }
+    }
+}
+
+// Pick the way of a set to replace
+static int choose_way(Tlb *tlb, int set) {
+    int base = set * tlb->stride;
+
+    if (tlb->policy == TLB_FIFO) {
+        // Strict round robin, even over invalidated entries
+        int way = tlb->fifo_next[set];
+        tlb->fifo_next[set] = (way + 1) % tlb->ways;
+        return way;
+    }
+
+    // Other policies fill an empty way first
+    for (int way = 0; way < tlb->ways; way++) {
+        if (tlb->pages[base + way] == TLB_INVALID) {
+            return way;
+        }
+    }
+
+    if (tlb->policy == TLB_LRU) {
+        int victim = 0;
+        for (int way = 1; way < tlb->ways; way++) {
+            if (tlb->last_used[base + way] < tlb->last_used[base + victim]) {
+                victim = way;
+            }
+        }
+        return victim;
+    }
+    if (tlb->policy == TLB_PLRU) {
+        // Follow the tree bits down to the pseudo-least recently used way
+        const uint8_t *bits = tlb->plru_bits + (size_t)set * tlb->ways;
+        int node = 0;
+        while (node < tlb->ways - 1) {
+            node = 2 * node + 1 + bits[node];
+        }
+        return node - (tlb->ways - 1);
+    }
+
+    // Random
+    uint32_t x = tlb->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tlb->random_state = x;
+    return x % tlb->ways;
+}
+
+void tlb_insert_evict(Tlb *tlb, int64_t page_number, int frame_number,
+                      int64_t *evicted_page, int *evicted_frame) {
+    int set = (int)(page_number & (tlb->sets - 1));
+    int index = set * tlb->stride + choose_way(tlb, set);
+    *evicted_page = tlb->pages[index];
+    *evicted_frame = tlb->frames[index];
+    tlb->pages[index] = page_number;
+    tlb->frames[index] = frame_number;
+    tlb_touch(tlb, index);
+}
+
+void tlb_insert(Tlb *tlb, int64_t page_number, int frame_number) {
+    int64_t evicted_page;
+    int evicted_frame;
+    tlb_insert_evict(tlb, page_number, frame_number, &evicted_page, &evicted_frame);
+}
+
+void tlb_invalidate(Tlb *tlb, int64_t page_number) {
+    int index = tlb_find(tlb, page_number);
+    if (index >= 0) {
+        tlb->pages[index] = TLB_INVALID;
+    }
+}
+
+void tlb_hierarchy_init(TlbHierarchy *tlbs, Tlb *l1, Tlb *l2, TlbInclusion inclusion) {
+    memset(tlbs, 0, sizeof(*tlbs));
+    tlbs->l1 = *l1;
+    if (l2 != NULL) {
+        tlbs->l2 = *l2;
+        tlbs->has_l2 = true;
+    }
+    tlbs->inclusion = inclusion;
+}
+
+void tlb_hierarchy_destroy(TlbHierarchy *tlbs) {
+    tlb_destroy(&tlbs->l1);
+    if (tlbs->has_l2) {
+        tlb_destroy(&tlbs->l2);
+    }
+}
+
+int tlb_inclusion_from_name(const char *name) {
+    if (strcmp(name, "inclusive") == 0) {
+        return TLB_INCLUSIVE;
+    } else if (strcmp(name, "exclusive") == 0) {
+        return TLB_EXCLUSIVE;
+    } else if (strcmp(name, "nine") == 0) {
+        return TLB_NINE;
+    }
+    return -1;
+}
+
+// Insert into L1; under exclusion the displaced L1 entry moves down to L2
+static void fill_l1(TlbHierarchy *tlbs, int64_t page_number, int frame_number) {
+    int64_t evicted_page;
+    int evicted_frame;
+    tlb_insert_evict(&tlbs->l1, page_number, frame_number, &evicted_page, &evicted_frame);
+    if (tlbs->has_l2 && tlbs->inclusion == TLB_EXCLUSIVE && evicted_page != TLB_INVALID) {
+        tlb_insert(&tlbs->l2, evicted_page, evicted_frame);
+    }
+}
+
+int tlb_hierarchy_lookup(TlbHierarchy *tlbs, int64_t page_number) {
+    int frame_number = tlb_lookup(&tlbs->l1, page_number);
+    if (frame_number != -1) {
+        tlbs->l1_hits++;
+        return frame_number;
+    }
+
+    if (tlbs->has_l2) {
+        frame_number = tlb_lookup(&tlbs->l2, page_number);
+        if (frame_number != -1) {
+            tlbs->l2_hits++;
+            if (tlbs->inclusion == TLB_EXCLUSIVE) {
+                tlb_invalidate(&tlbs->l2, page_number);
+            }
+            fill_l1(tlbs, page_number, frame_number);
+            return frame_number;
+        }
+    }
+
+    tlbs->walks++;
+    return -1;
+}
+
+int tlb_hierarchy_lookup_keys(TlbHierarchy *tlbs, const int64_t *keys, int count, int *which) {
+    for (int k = 0; k < count; k++) {
+        int frame_number = tlb_lookup(&tlbs->l1, keys[k]);
+        if (frame_number != -1) {
+            tlbs->l1_hits++;
+            *which = k;
+            return frame_number;
+        }
+    }
+
+    if (tlbs->has_l2) {
+        for (int k = 0; k < count; k++) {
+            int frame_number = tlb_lookup(&tlbs->l2, keys[k]);
+            if (frame_number != -1) {
+                tlbs->l2_hits++;
+                if (tlbs->inclusion == TLB_EXCLUSIVE) {
+                    tlb_invalidate(&tlbs->l2, keys[k]);
+                }
+                fill_l1(tlbs, keys[k], frame_number);
+                *which = k;
+                return frame_number;
+            }
+        }
+    }
+
+    tlbs->walks++;
+    return -1;
+}
+
+void tlb_hierarchy_fill(TlbHierarchy *tlbs, int64_t page_number, int frame_number) {
+    if (tlbs->has_l2 && tlbs->inclusion != TLB_EXCLUSIVE) {
+        int64_t evicted_page;
+        int evicted_frame;
+        tlb_insert_evict(&tlbs->l2, page_number, frame_number, &evicted_page, &evicted_frame);
+        if (tlbs->inclusion == TLB_INCLUSIVE && evicted_page != TLB_INVALID) {
+            // Keep L1 a subset of L2
+            tlb_invalidate(&tlbs->l1, evicted_page);
+        }
+    }
+    fill_l1(tlbs, page_number, frame_number);
+}
+
+void tlb_hierarchy_invalidate(TlbHierarchy *tlbs, int64_t page_number) {
+    tlb_invalidate(&tlbs->l1, page_number);
+    if (tlbs->has_l2) {
+        tlb_invalidate(&tlbs->l2, page_number);
+    }
+}
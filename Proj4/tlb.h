@@ -0,0 +1,183 @@
+/**
+ * Project 4 - Translation lookaside buffer
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * The TLB is stored as separate page and frame arrays (structure of
+ * arrays) with empty slots marked by TLB_INVALID, so a lookup is a
+ * compare-and-movemask over the entries of one set: AVX2 or SSE2 compares
+ * over the set, with a scalar loop when neither is available. Page numbers
+ * are 64-bit so wide address spaces fit.
+ *
+ * Geometry is chosen at run time: `size` entries split into sets of `ways`
+ * entries (ways == size is fully associative, ways == 1 is direct-mapped).
+ * A page maps to set (page % sets), so the number of sets must be a power
+ * of two. Each set is padded to a multiple of 8 entries for the SIMD
+ * compare, so lookup cost depends only on the geometry, never on contents.
+ *
+ * Replacement within a set is FIFO, LRU (per-entry timestamps), random
+ * (xorshift), or tree pseudo-LRU (ways must be a power of two).
+ *
+ * A TlbHierarchy optionally puts a second-level (unified STLB) TLB behind
+ * the first, kept inclusive, exclusive, or non-inclusive non-exclusive
+ * (NINE) with respect to L1, and counts hits per level.
+ */
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define TLB_SIZE 16            // Default number of entries in TLB
+#define TLB_INVALID (-1)       // Page number stored in empty entries
+#define TLB_POLICY_NAMES "fifo|lru|random|plru"
+#define TLB_INCLUSION_NAMES "inclusive|exclusive|nine"
+
+// Replacement policy within a set
+typedef enum {
+    TLB_FIFO,
+    TLB_LRU,
+    TLB_RANDOM,
+    TLB_PLRU
+} TlbPolicy;
+
+// How the L2 TLB's contents relate to L1's
+typedef enum {
+    TLB_INCLUSIVE,         // Everything in L1 is also in L2
+    TLB_EXCLUSIVE,         // L2 holds only entries evicted from L1
+    TLB_NINE               // Filled like inclusive, but no back-invalidation
+} TlbInclusion;
+
+// TLB state
+typedef struct {
+    int size;              // Total number of entries
+    int ways;              // Entries per set
+    int sets;              // Number of sets (power of two)
+    int stride;            // Entries per set including SIMD padding
+    TlbPolicy policy;
+    int64_t *pages;        // Page number per entry (sets * stride)
+    int32_t *frames;       // Frame number per entry (sets * stride)
+    int *fifo_next;        // Next way to replace in each set (FIFO)
+    uint64_t *last_used;   // Use stamp per entry (LRU)
+    uint64_t clock;        // Current use stamp (LRU; 64 bits never wrap)
+    uint8_t *plru_bits;    // Tree bits, ways - 1 per set (PLRU)
+    uint32_t random_state; // xorshift state (random)
+} Tlb;
+
+// Set up a TLB; ways == 0 means fully associative. Returns 0 on success,
+// -1 for an unsupported geometry or on allocation failure.
+int tlb_init(Tlb *tlb, int size, int ways, TlbPolicy policy);
+
+// Release the TLB's arrays
+void tlb_destroy(Tlb *tlb);
+
+// Parse a policy name; returns -1 if unknown
+int tlb_policy_from_name(const char *name);
+
+// Insert a translation, replacing an entry of the page's set
+void tlb_insert(Tlb *tlb, int64_t page_number, int frame_number);
+
+// Insert a translation and report the entry it replaced
+// (*evicted_page is TLB_INVALID if the slot was empty)
+void tlb_insert_evict(Tlb *tlb, int64_t page_number, int frame_number,
+                      int64_t *evicted_page, int *evicted_frame);
+
+// Invalidate the entry for a page (if present)
+void tlb_invalidate(Tlb *tlb, int64_t page_number);
+
+// Update replacement state after a hit on an entry
+void tlb_touch(Tlb *tlb, int index);
+
+// Find the entry holding a page; returns its index or -1
+static inline int tlb_find(const Tlb *tlb, int64_t page_number) {
+    int base = (int)(page_number & (tlb->sets - 1)) * tlb->stride;
+    const int64_t *pages = tlb->pages + base;
+
+    if (tlb->ways == 1) {
+        return pages[0] == page_number ? base : -1;
+    }
+#if defined(__AVX2__)
+    __m256i key = _mm256_set1_epi64x(page_number);
+    for (int i = 0; i < tlb->stride; i += 8) {
+        __m256i lo = _mm256_cmpeq_epi64(_mm256_load_si256((const __m256i *)&pages[i]), key);
+        __m256i hi = _mm256_cmpeq_epi64(_mm256_load_si256((const __m256i *)&pages[i + 4]), key);
+        unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+                        ((unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4);
+        if (mask) {
+            return base + i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    // SSE2 has no 64-bit compare: both 32-bit halves of a lane must match
+    __m128i key = _mm_set1_epi64x(page_number);
+    for (int i = 0; i < tlb->stride; i += 2) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)&pages[i]), key);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        unsigned mask = (unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask) {
+            return base + i + __builtin_ctz(mask);
+        }
+    }
+#else
+    for (int i = 0; i < tlb->ways; i++) {
+        if (pages[i] == page_number) {
+            return base + i;
+        }
+    }
+#endif
+    return -1;
+}
+
+// Look up a page; returns its frame number or -1 on a TLB miss
+static inline int tlb_lookup(Tlb *tlb, int64_t page_number) {
+    int index = tlb_find(tlb, page_number);
+    if (index < 0) {
+        return -1;
+    }
+    if (tlb->policy == TLB_LRU || tlb->policy == TLB_PLRU) {
+        tlb_touch(tlb, index);
+    }
+    return tlb->frames[index];
+}
+
+// Two-level TLB with per-level hit counters
+typedef struct {
+    Tlb l1;                // First-level TLB
+    Tlb l2;                // Second-level TLB (when has_l2)
+    bool has_l2;
+    TlbInclusion inclusion;
+    long l1_hits;          // Translations found in L1
+    long l2_hits;          // Translations missed in L1, found in L2
+    long walks;            // Translations missed in every level
+} TlbHierarchy;
+
+// Set up a hierarchy around an initialized L1 and, if l2 is non-NULL, an
+// initialized L2 (both are taken over by the hierarchy)
+void tlb_hierarchy_init(TlbHierarchy *tlbs, Tlb *l1, Tlb *l2, TlbInclusion inclusion);
+
+// Release both levels
+void tlb_hierarchy_destroy(TlbHierarchy *tlbs);
+
+// Parse an inclusion policy name; returns -1 if unknown
+int tlb_inclusion_from_name(const char *name);
+
+// Look up a page in L1 then L2 (promoting L2 hits into L1); returns the
+// frame number, or -1 when a page walk is needed
+int tlb_hierarchy_lookup(TlbHierarchy *tlbs, int64_t page_number);
+
+// Look up several keys (e.g. one per page size) in L1, then in L2, counting
+// one hit or walk in all; returns the frame number and stores the index of
+// the key that hit in *which, or returns -1 when a page walk is needed
+int tlb_hierarchy_lookup_keys(TlbHierarchy *tlbs, const int64_t *keys, int count, int *which);
+
+// Install a translation found by a page walk
+void tlb_hierarchy_fill(TlbHierarchy *tlbs, int64_t page_number, int frame_number);
+
+// Invalidate a page in every level
+void tlb_hierarchy_invalidate(TlbHierarchy *tlbs, int64_t page_number);
+
+#endif
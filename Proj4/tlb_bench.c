@@ -0,0 +1,111 @@
+/**
+ * Project 4 - TLB lookup micro-benchmark
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ * Usage: ./tlb_bench [lookups]
+ * Build: gcc -O2 -march=native -o tlb_bench tlb_bench.c tlb.c
+ *
+ * Compares per-lookup latency of the original array-of-structs TLB search
+ * (branch on every entry) against the structure-of-arrays SIMD lookup in
+ * tlb.h. Each lookup depends on the previous result so the timings are
+ * latency, not throughput.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "tlb.h"
+
+#define PAGE_COUNT 256
+
+// Original TLB entry structure
+typedef struct {
+    int page_number;
+    int frame_number;
+    bool valid;
+} TLB_Entry;
+
+// Original lookup: linear scan with a branch per entry
+static int aos_lookup(const TLB_Entry *tlb, int page_number) {
+    for (int i = 0; i < TLB_SIZE; i++) {
+        if (tlb[i].valid && tlb[i].page_number == page_number) {
+            return tlb[i].frame_number;
+        }
+    }
+    return -1;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    long lookups = argc > 1 ? atol(argv[1]) : 50000000;
+    if (lookups <= 0) {
+        fprintf(stderr, "Usage: %s [lookups]\n", argv[0]);
+        return -1;
+    }
+
+    // Fill both TLBs with the same 16 pages (frame = page + 1)
+    TLB_Entry aos[TLB_SIZE];
+    Tlb soa;
+    if (tlb_init(&soa, TLB_SIZE, 0, TLB_FIFO) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return -1;
+    }
+    for (int i = 0; i < TLB_SIZE; i++) {
+        int page = i * (PAGE_COUNT / TLB_SIZE);
+        aos[i].page_number = page;
+        aos[i].frame_number = page + 1;
+        aos[i].valid = true;
+        tlb_insert(&soa, page, page + 1);
+    }
+
+    // Random page sequence: 1 in 16 pages is resident, so mostly misses
+    // (the common case while a trace is faulting in)
+    int pages[4096];
+    srand(1);
+    for (int i = 0; i < 4096; i++) {
+        pages[i] = rand() % PAGE_COUNT;
+    }
+
+    // Chain each lookup on the previous result to measure latency
+    double start = now_ns();
+    int carry = 0;
+    for (long i = 0; i < lookups; i++) {
+        int frame = aos_lookup(aos, pages[(i + carry) & 4095]);
+        carry = frame & 1;
+    }
+    double aos_ns = (now_ns() - start) / lookups;
+    int aos_carry = carry;
+
+    start = now_ns();
+    carry = 0;
+    for (long i = 0; i < lookups; i++) {
+        int frame = tlb_lookup(&soa, pages[(i + carry) & 4095]);
+        carry = frame & 1;
+    }
+    double soa_ns = (now_ns() - start) / lookups;
+
+    tlb_destroy(&soa);
+    if (carry != aos_carry) {
+        fprintf(stderr, "Error: Lookup results differ\n");
+        return -1;
+    }
+
+#if defined(__AVX2__)
+    const char *kind = "AVX2";
+#elif defined(__SSE2__)
+    const char *kind = "SSE2";
+#else
+    const char *kind = "scalar";
+#endif
+    printf("Lookups: %ld\n", lookups);
+    printf("Array-of-structs scan: %.2f ns/lookup\n", aos_ns);
+    printf("Structure-of-arrays %s: %.2f ns/lookup\n", kind, soa_ns);
+    printf("Speedup = %.2fx\n", aos_ns / soa_ns);
+    return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * Project 4 - Address trace input
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * The whole file is mapped (or block-read when it cannot be mapped, e.g. a
+ * pipe) and decoded TRACE_BLOCK addresses at a time, so the per-address cost
+ * is a few instructions instead of a fscanf call.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+// Read everything from fd into a malloc'd buffer (fallback for unmappable input)
+static int read_all(int fd, TraceReader *reader) {
+    size_t capacity = 1 << 16;
+    size_t size = 0;
+    unsigned char *data = malloc(capacity);
+    if (data == NULL) {
+        return -1;
+    }
+
+    while (1) {
+        if (size == capacity) {
+            capacity *= 2;
+            unsigned char *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+                return -1;
+            }
+            data = grown;
+        }
+        ssize_t got = read(fd, data + size, capacity - size);
+        if (got < 0) {
+            free(data);
+            return -1;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += got;
+    }
+
+    reader->data = data;
+    reader->size = size;
+    reader->mapped = false;
+    return 0;
+}
+
+int trace_open(TraceReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            reader->data = (const unsigned char *)map;
+            reader->size = (size_t)st.st_size;
+            reader->mapped = true;
+        }
+    }
+    if (!reader->mapped && read_all(fd, reader) != 0) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    // Detect the binary format by its magic number
+    if (reader->size >= TRACE_HEADER_SIZE && memcmp(reader->data, TRACE_MAGIC, 4) == 0) {
+        const unsigned char *h = reader->data;
+        reader->binary = true;
+        reader->width = h[5];
+        reader->remaining = 0;
+        for (int i = 7; i >= 0; i--) {
+            reader->remaining = (reader->remaining << 8) | h[8 + i];
+        }
+        reader->pos = TRACE_HEADER_SIZE;
+
+        if (h[4] != TRACE_VERSION || (reader->width != 2 && reader->width != 4 && reader->width != 8) ||
+            (h[6] & ~(TRACE_FLAG_ACCESS | TRACE_FLAG_ASID)) != 0) {
+            fprintf(stderr, "Error: Unsupported binary trace (version %d, width %d, flags %d)\n",
+                    h[4], h[5], h[6]);
+            trace_close(reader);
+            return -1;
+        }
+        reader->has_writes = (h[6] & TRACE_FLAG_ACCESS) != 0;
+        reader->has_asids = (h[6] & TRACE_FLAG_ASID) != 0;
+        reader->record_size = reader->width + (reader->has_writes ? 1 : 0) +
+                              (reader->has_asids ? 2 : 0);
+        uint64_t available = (reader->size - TRACE_HEADER_SIZE) / reader->record_size;
+        if (reader->remaining > available) {
+            fprintf(stderr, "Warning: Binary trace is truncated; reading %llu of %llu records\n",
+                    (unsigned long long)available, (unsigned long long)reader->remaining);
+            reader->remaining = available;
+        }
+    }
+    return 0;
+}
+
+// Decode packed little-endian records
+static size_t fill_binary(TraceReader *reader) {
+    size_t n = TRACE_BLOCK;
+    if (reader->remaining < n) {
+        n = (size_t)reader->remaining;
+    }
+
+    const unsigned char *p = reader->data + reader->pos;
+    if (reader->has_writes || reader->has_asids) {
+        // Access byte and/or ASID, then the address
+        int start = (reader->has_writes ? 1 : 0) + (reader->has_asids ? 2 : 0);
+        for (size_t i = 0; i < n; i++, p += reader->record_size) {
+            uint64_t value = 0;
+            for (int b = start + reader->width - 1; b >= start; b--) {
+                value = (value << 8) | p[b];
+            }
+            if (reader->has_writes) {
+                reader->writes[i] = p[0] != 0;
+            }
+            if (reader->has_asids) {
+                reader->asids[i] = (uint16_t)(p[start - 2] | (p[start - 1] << 8));
+            }
+            reader->block[i] = value;
+        }
+    } else if (reader->width == 2) {
+        for (size_t i = 0; i < n; i++, p += 2) {
+            reader->block[i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+        }
+    } else if (reader->width == 4) {
+        for (size_t i = 0; i < n; i++, p += 4) {
+            reader->block[i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                               ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++, p += 8) {
+            uint64_t value = 0;
+            for (int b = 7; b >= 0; b--) {
+                value = (value << 8) | p[b];
+            }
+            reader->block[i] = value;
+        }
+    }
+
+    reader->pos += n * reader->record_size;
+    reader->remaining -= n;
+    return n;
+}
+
+// Parse whitespace-separated decimal integers (same input fscanf("%d") accepts),
+// each optionally preceded by an R or W access marker and an "asid:" tag
+static size_t fill_text(TraceReader *reader) {
+    const unsigned char *p = reader->data + reader->pos;
+    const unsigned char *end = reader->data + reader->size;
+    size_t n = 0;
+
+    while (n < TRACE_BLOCK) {
+        while (p < end && (*p == ' ' || (*p >= '\t' && *p <= '\r'))) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+
+        // Optional access marker, possibly followed by blanks
+        bool write = false;
+        if (*p == 'R' || *p == 'r' || *p == 'W' || *p == 'w') {
+            write = (*p == 'W' || *p == 'w');
+            reader->has_writes = true;
+            p++;
+            while (p < end && (*p == ' ' || *p == '\t')) {
+                p++;
+            }
+        }
+
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = (*p == '-');
+            p++;
+        }
+        if (p == end || (unsigned)(*p - '0') > 9) {
+            fprintf(stderr, "Error: Invalid trace data at byte %zu\n",
+                    (size_t)(p - reader->data));
+            reader->error = true;
+            p = end;
+            break;
+        }
+
+        uint64_t value = 0;
+        while (p < end && (unsigned)(*p - '0') <= 9) {
+            value = value * 10 + (*p - '0');
+            p++;
+        }
+
+        // A colon means that number was the ASID and the address follows
+        uint16_t asid = 0;
+        if (p < end && *p == ':') {
+            p++;
+            if (negative || value > TRACE_MAX_ASID || p == end || (unsigned)(*p - '0') > 9) {
+                fprintf(stderr, "Error: Invalid ASID at byte %zu\n",
+                        (size_t)(p - reader->data));
+                reader->error = true;
+                p = end;
+                break;
+            }
+            asid = (uint16_t)value;
+            reader->has_asids = true;
+            value = 0;
+            while (p < end && (unsigned)(*p - '0') <= 9) {
+                value = value * 10 + (*p - '0');
+                p++;
+            }
+        }
+        reader->asids[n] = asid;
+        reader->writes[n] = write;
+        reader->block[n++] = negative ? (uint64_t)0 - value : value;
+    }
+
+    reader->pos = p - reader->data;
+    return n;
+}
+
+bool trace_fill(TraceReader *reader) {
+    reader->block_pos = 0;
+    reader->block_len = reader->binary ? fill_binary(reader) : fill_text(reader);
+    return reader->block_len > 0;
+}
+
+void trace_close(TraceReader *reader) {
+    if (reader->data != NULL) {
+        if (reader->mapped) {
+            munmap((void *)reader->data, reader->size);
+        } else {
+            free((void *)reader->data);
+        }
+    }
+    reader->data = NULL;
+    reader->size = 0;
+}
+
+uint64_t *trace_load(const char *path, long *count, uint16_t **asids) {
+    TraceReader *reader = malloc(sizeof(TraceReader));
+    if (reader == NULL) {
+        return NULL;
+    }
+    if (trace_open(reader, path) != 0) {
+        free(reader);
+        return NULL;
+    }
+
+    // Binary traces know their length; text traces grow as they go
+    long capacity = reader->binary && reader->remaining > 0 ? (long)reader->remaining : 1 << 16;
+    long n = 0;
+    uint64_t *addresses = malloc(capacity * sizeof(uint64_t));
+    uint16_t *tags = asids != NULL ? malloc(capacity * sizeof(uint16_t)) : NULL;
+    if (asids != NULL && tags == NULL) {
+        free(addresses);
+        addresses = NULL;
+    }
+    while (addresses != NULL && trace_fill(reader)) {
+        if (n + (long)reader->block_len > capacity) {
+            while (n + (long)reader->block_len > capacity) {
+                capacity *= 2;
+            }
+            uint64_t *grown = realloc(addresses, capacity * sizeof(uint64_t));
+            uint16_t *grown_tags = tags != NULL ? realloc(tags, capacity * sizeof(uint16_t)) : NULL;
+            if (grown != NULL) {
+                addresses = grown;
+            }
+            if (grown_tags != NULL) {
+                tags = grown_tags;
+            }
+            if (grown == NULL || (tags != NULL && grown_tags == NULL)) {
+                free(addresses);
+                addresses = NULL;
+                break;
+            }
+        }
+        memcpy(addresses + n, reader->block, reader->block_len * sizeof(uint64_t));
+        if (tags != NULL) {
+            memcpy(tags + n, reader->asids, reader->block_len * sizeof(uint16_t));
+        }
+        n += reader->block_len;
+    }
+    bool has_asids = reader->has_asids;
+    if (reader->error) {
+        free(addresses);
+        addresses = NULL;
+    }
+    trace_close(reader);
+    free(reader);
+
+    if (asids != NULL) {
+        if (addresses == NULL || !has_asids) {
+            free(tags);
+            tags = NULL;
+        }
+        *asids = tags;
+    }
+    *count = n;
+    return addresses;
+}
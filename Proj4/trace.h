@@ -0,0 +1,108 @@
+/**
+ * Project 4 - Address trace input
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Reads address traces in either of two formats, detected automatically:
+ * - Text: whitespace-separated decimal integers (the addresses.txt format),
+ *   each optionally prefixed by an access marker R or W ("W 1234" or
+ *   "W1234"); unmarked addresses are reads. In multi-process traces an
+ *   address may also carry an address-space ID (ASID, 0-65535) and a
+ *   colon ("W 3:1234"); untagged addresses belong to ASID 0
+ * - Binary: a 16-byte header followed by packed little-endian addresses
+ *
+ * Binary header layout (all fields little-endian):
+ *   bytes 0-3   magic "VMTR"
+ *   byte  4     format version (TRACE_VERSION)
+ *   byte  5     record width in bytes (2, 4 or 8)
+ *   byte  6     flags (TRACE_FLAG_ACCESS: each record is preceded by one
+ *               access byte, 0 = read, 1 = write; TRACE_FLAG_ASID: each
+ *               address is preceded by a 2-byte ASID, after any access byte)
+ *   byte  7     reserved (0)
+ *   bytes 8-15  number of records
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_MAGIC "VMTR"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 16
+#define TRACE_BLOCK 4096       // Addresses decoded per refill
+#define TRACE_FLAG_ACCESS 0x01 // Binary records carry an access byte
+#define TRACE_FLAG_ASID 0x02   // Binary records carry a 2-byte ASID
+#define TRACE_MAX_ASID 65535
+
+// Trace reader state
+typedef struct {
+    const unsigned char *data; // Whole file (mapped or block-read)
+    size_t size;               // Size of the file in bytes
+    size_t pos;                // Next unread byte
+    bool mapped;               // data is an mmap (otherwise malloc'd)
+    bool binary;               // Binary format detected
+    int width;                 // Address width for binary traces
+    int record_size;           // Bytes per binary record (with access byte)
+    bool has_writes;           // Write markers are possible (and reported)
+    bool has_asids;            // ASID tags are possible (and reported)
+    uint64_t remaining;        // Records left in a binary trace
+    bool error;                // Malformed input was encountered (reading stopped there)
+    uint64_t block[TRACE_BLOCK]; // Decoded addresses
+    uint8_t writes[TRACE_BLOCK]; // 1 where the access is a write
+    uint16_t asids[TRACE_BLOCK]; // Address space of each address
+    size_t block_len;          // Number of valid entries in block
+    size_t block_pos;          // Next entry to hand out
+} TraceReader;
+
+// Open a trace file; returns 0 on success, -1 on error
+int trace_open(TraceReader *reader, const char *path);
+
+// Decode the next block of addresses; returns false at end of trace or at
+// malformed input (reported on stderr, and `error` is set; callers check it
+// once the reads stop)
+bool trace_fill(TraceReader *reader);
+
+// Release the file contents
+void trace_close(TraceReader *reader);
+
+// Read a whole trace into a malloc'd array; returns NULL on error (including
+// malformed input). If asids is not NULL it receives a malloc'd array of
+// each address's ASID, or NULL if the trace has no ASID tags.
+uint64_t *trace_load(const char *path, long *count, uint16_t **asids);
+
+// Fetch the next address; returns false at end of trace
+static inline bool trace_next(TraceReader *reader, uint64_t *address) {
+    if (reader->block_pos == reader->block_len && !trace_fill(reader)) {
+        return false;
+    }
+    *address = reader->block[reader->block_pos++];
+    return true;
+}
+
+// Fetch the next address and whether it is a write; returns false at end of trace
+static inline bool trace_next_access(TraceReader *reader, uint64_t *address, bool *write) {
+    if (reader->block_pos == reader->block_len && !trace_fill(reader)) {
+        return false;
+    }
+    *write = reader->writes[reader->block_pos] != 0;
+    *address = reader->block[reader->block_pos++];
+    return true;
+}
+
+// Fetch the next address, whether it is a write and its ASID; returns false
+// at end of trace
+static inline bool trace_next_ref(TraceReader *reader, uint64_t *address, bool *write,
+                                  uint16_t *asid) {
+    if (reader->block_pos == reader->block_len && !trace_fill(reader)) {
+        return false;
+    }
+    *write = reader->writes[reader->block_pos] != 0;
+    *asid = reader->asids[reader->block_pos];
+    *address = reader->block[reader->block_pos++];
+    return true;
+}
+
+#endif
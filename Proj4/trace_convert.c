@@ -0,0 +1,120 @@
+/**
+ * Project 4 - Trace converter
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ * Usage: ./trace_convert input_trace output_trace [16|32|64]
+ * Build: gcc -o trace_convert trace_convert.c trace.c
+ *
+ * Converts a text address trace (addresses.txt format) into the packed
+ * binary trace format described in trace.h. Without an explicit width the
+ * smallest one that holds every address exactly is chosen. An explicit
+ * narrower width truncates addresses to their low bits (the simulators
+ * only use the low --address-bits bits anyway). If the text trace has R/W
+ * access markers or ASID tags, they are kept as per-record access bytes
+ * and ASIDs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+// Write a little-endian value of the given width
+static void put_le(FILE *out, uint64_t value, int width) {
+    unsigned char bytes[8];
+    for (int i = 0; i < width; i++) {
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+    fwrite(bytes, 1, width, out);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s input_trace output_trace [16|32|64]\n", argv[0]);
+        return -1;
+    }
+
+    int width = 0;
+    if (argc == 4) {
+        int bits = atoi(argv[3]);
+        if (bits != 16 && bits != 32 && bits != 64) {
+            fprintf(stderr, "Error: Width must be 16, 32 or 64\n");
+            return -1;
+        }
+        width = bits / 8;
+    }
+
+    TraceReader reader;
+    if (trace_open(&reader, argv[1]) != 0) {
+        fprintf(stderr, "Error: Could not open file %s\n", argv[1]);
+        return -1;
+    }
+
+    // First pass: count records and pick the width if not given
+    uint64_t count = 0;
+    uint64_t largest = 0;
+    uint64_t address;
+    bool write;
+    uint16_t asid;
+    while (trace_next_ref(&reader, &address, &write, &asid)) {
+        count++;
+        if (address > largest) {
+            largest = address;
+        }
+    }
+    bool has_writes = reader.has_writes;
+    bool has_asids = reader.has_asids;
+    bool malformed = reader.error;
+    trace_close(&reader);
+    if (malformed) {
+        fprintf(stderr, "Error: Could not convert %s\n", argv[1]);
+        return -1;
+    }
+    if (width == 0) {
+        width = largest <= 0xFFFF ? 2 : largest <= 0xFFFFFFFF ? 4 : 8;
+    }
+
+    FILE *out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Error: Could not open file %s\n", argv[2]);
+        return -1;
+    }
+
+    // Header
+    fwrite(TRACE_MAGIC, 1, 4, out);
+    put_le(out, TRACE_VERSION, 1);
+    put_le(out, width, 1);
+    put_le(out, (has_writes ? TRACE_FLAG_ACCESS : 0) | (has_asids ? TRACE_FLAG_ASID : 0), 1);
+    put_le(out, 0, 1);
+    put_le(out, count, 8);
+
+    // Second pass: write the packed records
+    if (trace_open(&reader, argv[1]) != 0) {
+        fprintf(stderr, "Error: Could not reopen file %s\n", argv[1]);
+        fclose(out);
+        return -1;
+    }
+    while (trace_next_ref(&reader, &address, &write, &asid)) {
+        if (has_writes) {
+            put_le(out, write ? 1 : 0, 1);
+        }
+        if (has_asids) {
+            put_le(out, asid, 2);
+        }
+        put_le(out, address, width);
+    }
+    malformed = reader.error;
+    trace_close(&reader);
+
+    // Don't leave a partial output behind
+    if (fclose(out) != 0 || malformed) {
+        fprintf(stderr, "Error: Could not write %s\n", argv[2]);
+        remove(argv[2]);
+        return -1;
+    }
+
+    printf("Converted %llu addresses to %d-bit binary trace %s%s%s\n",
+           (unsigned long long)count, width * 8, argv[2], has_writes ? " with access markers" : "",
+           has_asids ? (has_writes ? " and ASIDs" : " with ASIDs") : "");
+    return 0;
+}
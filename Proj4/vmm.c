@@ -0,0 +1,722 @@
+/**
+ * Project 4 - Virtual memory manager core
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vmm.h"
+
+void vmm_config_init(VmmConfig *config) {
+    config->frame_count = 128;
+    config->address_bits = ADDRESS_BITS;
+    config->page_size = PAGE_SIZE;
+    config->page_table = "radix";
+    config->page_table_levels = 0;
+    config->policy = "lru";
+    config->next_use = NULL;
+    config->ws_window = WS_WINDOW;
+    config->pff_interval = PFF_INTERVAL;
+    config->tlb_size = TLB_SIZE;
+    config->tlb_ways = 0;
+    config->tlb_policy = "fifo";
+    config->l2_tlb_size = 0;
+    config->l2_tlb_ways = 0;
+    config->l2_tlb_policy = "lru";
+    config->tlb_inclusion = "inclusive";
+    config->writeback_batch = WRITEBACK_BATCH;
+    config->async_writeback = false;
+    config->prefetch = "none";
+    config->prefetch_degree = PREFETCH_DEGREE;
+    config->prefetch_frames = PREFETCH_FRAMES;
+    cost_model_init(&config->cost);
+    config->huge_pages = NULL;
+    config->huge_page_count = 0;
+    config->promote_percent = PROMOTE_PERCENT;
+}
+
+// log2 of the page size, or -1 if the address geometry is unsupported
+static int page_bits_of(const VmmConfig *config) {
+    int page_bits = 0;
+    while (page_bits < 30 && (1 << page_bits) < config->page_size) {
+        page_bits++;
+    }
+    if (config->page_size < 16 || (1 << page_bits) != config->page_size ||
+        config->address_bits < 16 || config->address_bits > 64 ||
+        page_bits >= config->address_bits) {
+        return -1;
+    }
+    return page_bits;
+}
+
+static uint64_t address_mask_of(const VmmConfig *config) {
+    return config->address_bits == 64 ? ~(uint64_t)0 : ((uint64_t)1 << config->address_bits) - 1;
+}
+
+int vmm_max_frames(const VmmConfig *config) {
+    int page_bits = page_bits_of(config);
+    if (page_bits == -1) {
+        return MAX_FRAMES;
+    }
+    int page_number_bits = config->address_bits - page_bits;
+    return page_number_bits >= 24 ? MAX_WIDE_FRAMES : 1 << page_number_bits;
+}
+
+// Set up one TLB level, reporting bad options; returns 0 on success
+static int setup_tlb(Tlb *tlb, const char *level, int size, int ways, const char *policy_name) {
+    int policy = tlb_policy_from_name(policy_name);
+    if (policy == -1) {
+        fprintf(stderr, "Error: Unknown %s TLB policy %s (choose %s)\n", level, policy_name, TLB_POLICY_NAMES);
+        return -1;
+    }
+    if (tlb_init(tlb, size, ways, (TlbPolicy)policy) != 0) {
+        fprintf(stderr, "Error: Unsupported %s TLB geometry (size %d, ways %d, policy %s)\n",
+                level, size, ways, policy_name);
+        fprintf(stderr, "       size must be a multiple of ways with a power-of-two number of sets;\n"
+                        "       plru also needs a power-of-two number of ways\n");
+        return -1;
+    }
+    return 0;
+}
+
+Vmm *vmm_create(const VmmConfig *config, BackingStore *store) {
+    int page_bits = page_bits_of(config);
+    if (page_bits == -1) {
+        fprintf(stderr, "Error: Unsupported geometry (%d-bit addresses, %d-byte pages)\n",
+                config->address_bits, config->page_size);
+        fprintf(stderr, "       addresses must be 16-64 bits and pages a power of two of at\n"
+                        "       least 16 bytes, smaller than the address space\n");
+        return NULL;
+    }
+    int max_frames = vmm_max_frames(config);
+    if (config->frame_count <= 0 || config->frame_count > max_frames) {
+        fprintf(stderr, "Error: Frame count must be between 1 and %d\n", max_frames);
+        return NULL;
+    }
+    int inclusion = tlb_inclusion_from_name(config->tlb_inclusion);
+    if (inclusion == -1) {
+        fprintf(stderr, "Error: Unknown TLB inclusion policy %s (choose %s)\n",
+                config->tlb_inclusion, TLB_INCLUSION_NAMES);
+        return NULL;
+    }
+
+    Vmm *vm = calloc(1, sizeof(Vmm));
+    if (vm == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return NULL;
+    }
+    vm->frame_count = config->frame_count;
+    vm->page_size = config->page_size;
+    vm->page_bits = page_bits;
+    vm->vpn_bits = config->address_bits - page_bits;
+    vm->address_mask = address_mask_of(config);
+    vm->store = store;
+    vm->cost = config->cost;
+
+    // Process 0 exists from the start; others are added as their ASIDs appear
+    vm->processes = calloc(1, sizeof(VmmProcess));
+    if (vm->processes == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(vm);
+        return NULL;
+    }
+    vm->process_count = 1;
+    vm->process_capacity = 1;
+
+    // Page table - radix tables are allocated (all entries invalid) as pages
+    // are touched; the inverted table is allocated below with the frames
+    PageTable *page_table = &vm->processes[0].page_table;
+    if (strcmp(config->page_table, "inverted") == 0) {
+        vm->inverted = true;
+    } else if (strcmp(config->page_table, "radix") != 0) {
+        fprintf(stderr, "Error: Unknown page table %s (choose %s)\n", config->page_table, PAGE_TABLE_NAMES);
+        vmm_destroy(vm);
+        return NULL;
+    } else if (page_table_init(page_table, vm->vpn_bits, config->page_table_levels) != 0) {
+        fprintf(stderr, "Error: Unsupported page table layout (%d levels for %d-bit page numbers)\n",
+                config->page_table_levels, vm->vpn_bits);
+        vmm_destroy(vm);
+        return NULL;
+    }
+
+    // A walk reads one entry per radix level, or one inverted table bucket
+    vm->walk_levels = vm->inverted ? 1 : page_table->levels;
+
+    // Set up the TLBs - all entries initially invalid
+    Tlb l1_tlb, l2_tlb;
+    bool has_l2 = config->l2_tlb_size > 0;
+    if (setup_tlb(&l1_tlb, "L1", config->tlb_size, config->tlb_ways, config->tlb_policy) != 0) {
+        vmm_destroy(vm);
+        return NULL;
+    }
+    if (has_l2 && setup_tlb(&l2_tlb, "L2", config->l2_tlb_size, config->l2_tlb_ways,
+                            config->l2_tlb_policy) != 0) {
+        tlb_destroy(&l1_tlb);
+        vmm_destroy(vm);
+        return NULL;
+    }
+    tlb_hierarchy_init(&vm->tlbs, &l1_tlb, has_l2 ? &l2_tlb : NULL, (TlbInclusion)inclusion);
+
+    // Create the replacement policy
+    if (config->ws_window <= 0 || config->pff_interval <= 0) {
+        fprintf(stderr, "Error: Working-set window and PFF interval must be positive\n");
+        vmm_destroy(vm);
+        return NULL;
+    }
+    if (strcmp(config->policy, "opt") == 0 && config->next_use == NULL) {
+        fprintf(stderr, "Error: The opt policy needs the trace's next-use indices (see vmm_next_use)\n");
+        vmm_destroy(vm);
+        return NULL;
+    }
+    PolicyParams params;
+    params.next_use = config->next_use;
+    params.asid_shift = vm->vpn_bits;
+    params.ws_window = config->ws_window;
+    params.pff_interval = config->pff_interval;
+    vm->policy = policy_create(config->policy, vm->frame_count, &params);
+    if (vm->policy == NULL) {
+        fprintf(stderr, "Error: Unknown replacement policy %s (choose %s)\n", config->policy, POLICY_NAMES);
+        vmm_destroy(vm);
+        return NULL;
+    }
+
+    // Allocate physical memory (only when pages are actually loaded) and the frame-to-page map
+    vm->frame_to_page = malloc(vm->frame_count * sizeof(int64_t));
+    if (store != NULL) {
+        vm->physical_memory = malloc((size_t)vm->frame_count * vm->page_size);
+    }
+    if (vm->frame_to_page == NULL || (store != NULL && vm->physical_memory == NULL) ||
+        (vm->inverted && invpt_init(&vm->inverted_table, vm->frame_count) != 0)) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        vmm_destroy(vm);
+        return NULL;
+    }
+    for (int i = 0; i < vm->frame_count; i++) {
+        vm->frame_to_page[i] = -1;  // Initialize to -1 (no page loaded)
+    }
+
+    // Dirty pages can only be written to a writable store
+    if (vm->physical_memory != NULL && store->writable) {
+        if (writeback_init(&vm->writeback, store, vm->page_size, config->writeback_batch,
+                           config->async_writeback) != 0) {
+            fprintf(stderr, "Error: Could not set up write-back (batch size %d)\n",
+                    config->writeback_batch);
+            vmm_destroy(vm);
+            return NULL;
+        }
+        vm->has_writeback = true;
+    }
+
+    // Prefetching needs a backing store to read from
+    int prefetch = prefetch_kind_from_name(config->prefetch);
+    if (prefetch == -1) {
+        fprintf(stderr, "Error: Unknown prefetcher %s (choose %s)\n", config->prefetch, PREFETCH_NAMES);
+        vmm_destroy(vm);
+        return NULL;
+    }
+    if (prefetch != PREFETCH_NONE && vm->physical_memory != NULL) {
+        if (prefetch_init(&vm->prefetcher, (PrefetchKind)prefetch, config->prefetch_degree,
+                          config->prefetch_frames, store, vm->page_size) != 0) {
+            fprintf(stderr, "Error: Could not set up prefetching (degree %d, %d frames; degree must be 1-%d)\n",
+                    config->prefetch_degree, config->prefetch_frames, PREFETCH_MAX_DEGREE);
+            vmm_destroy(vm);
+            return NULL;
+        }
+        vm->has_prefetch = true;
+    }
+
+    // Huge pages must fit the frames, the page numbers and the TLB key tag
+    if (config->huge_page_count > 0) {
+        if (hugepage_init(&vm->huge, config->huge_pages, config->huge_page_count,
+                          config->promote_percent) != 0) {
+            fprintf(stderr, "Error: Unsupported huge pages (up to %d distinct powers of two above 1,\n"
+                            "       promoted at 1-100%% resident)\n", MAX_HUGE_SIZES);
+            vmm_destroy(vm);
+            return NULL;
+        }
+        vm->has_huge = true;
+        int largest = 1 << vm->huge.shifts[vm->huge.count];
+        if (largest > vm->frame_count / 2 || vm->huge.shifts[vm->huge.count] > vm->vpn_bits ||
+            vm->vpn_bits > MAX_HUGE_PAGE_BITS) {
+            fprintf(stderr, "Error: Huge pages of %d base pages need at least %d frames and page\n"
+                            "       numbers of %d-%d bits\n", largest, 2 * largest,
+                    vm->huge.shifts[vm->huge.count], MAX_HUGE_PAGE_BITS);
+            vmm_destroy(vm);
+            return NULL;
+        }
+        if (strcmp(config->policy, "opt") == 0) {
+            fprintf(stderr, "Error: Huge pages cannot be used with opt (it only knows when\n"
+                            "       demand-faulted pages are used next)\n");
+            vmm_destroy(vm);
+            return NULL;
+        }
+    }
+    return vm;
+}
+
+void vmm_destroy(Vmm *vm) {
+    if (vm == NULL) {
+        return;
+    }
+    if (vm->has_prefetch) {
+        prefetch_destroy(&vm->prefetcher);
+    }
+    if (vm->has_writeback) {
+        writeback_destroy(&vm->writeback);
+    }
+    hugepage_destroy(&vm->huge);
+    policy_destroy(vm->policy);
+    tlb_hierarchy_destroy(&vm->tlbs);
+    for (int i = 0; i < vm->process_count; i++) {
+        page_table_destroy(&vm->processes[i].page_table);
+    }
+    free(vm->processes);
+    invpt_destroy(&vm->inverted_table);
+    free(vm->frame_to_page);
+    free(vm->physical_memory);
+    free(vm);
+}
+
+// Set up processes up to an ASID the first time it appears; returns -1
+// (with vm->failed set) if the ASID does not fit or memory ran out
+static int add_processes(Vmm *vm, uint16_t asid) {
+    if (!vmm_asids_ok(vm)) {
+        fprintf(stderr, "Error: ASIDs need page numbers of at most %d bits (these have %d)\n",
+                MAX_ASID_PAGE_BITS, vm->vpn_bits);
+        vm->failed = true;
+        return -1;
+    }
+    if (asid >= vm->process_capacity) {
+        int capacity = vm->process_capacity;
+        while (capacity <= asid) {
+            capacity *= 2;
+        }
+        VmmProcess *grown = realloc(vm->processes, capacity * sizeof(VmmProcess));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Out of memory for processes\n");
+            vm->failed = true;
+            return -1;
+        }
+        vm->processes = grown;
+        vm->process_capacity = capacity;
+    }
+    if (vm->policy->add_processes != NULL && vm->policy->add_processes(vm->policy, asid + 1) != 0) {
+        fprintf(stderr, "Error: Out of memory for processes\n");
+        vm->failed = true;
+        return -1;
+    }
+    while (vm->process_count <= asid) {
+        VmmProcess *process = &vm->processes[vm->process_count++];
+        memset(process, 0, sizeof(*process));
+        if (!vm->inverted) {
+            // Same layout as process 0, which was already validated
+            page_table_init(&process->page_table, vm->vpn_bits, vm->processes[0].page_table.levels);
+        }
+    }
+    return 0;
+}
+
+// Process owning a page key
+static inline VmmProcess *process_of(Vmm *vm, int64_t page_key) {
+    return &vm->processes[page_key >> vm->vpn_bits];
+}
+
+// Frame holding a resident page, or -1; for the radix table also returns
+// the page's entry when its table exists
+static inline int resident_frame(Vmm *vm, int64_t page_number, PageTableEntry **entry) {
+    if (vm->inverted) {
+        return invpt_lookup(&vm->inverted_table, page_number);
+    }
+    *entry = page_table_find(&process_of(vm, page_number)->page_table, page_number);
+    return *entry != NULL && (*entry)->valid ? (*entry)->frame_number : -1;
+}
+
+// Dirty flag of a resident page held in a frame
+static inline bool *dirty_flag(Vmm *vm, int64_t page_number, int frame_number) {
+    if (vm->inverted) {
+        return &vm->inverted_table.dirty[frame_number];
+    }
+    return &page_table_find(&process_of(vm, page_number)->page_table, page_number)->dirty;
+}
+
+// Predict the pages to follow a fault and start reading those not already
+// in memory or waiting to be written back
+static void prefetch_after_fault(Vmm *vm, int64_t page_number) {
+    int64_t predicted[PREFETCH_MAX_DEGREE];
+    int count = prefetch_predict(&vm->prefetcher, page_number, predicted);
+    for (int i = 0; i < count; i++) {
+        int64_t page = predicted[i];
+        PageTableEntry *entry;
+        // Stay inside the faulting process's address space
+        if (page < 0 || page >> vm->vpn_bits != page_number >> vm->vpn_bits || resident_frame(vm, page, &entry) != -1 ||
+            (vm->has_writeback && writeback_lookup(&vm->writeback, page, NULL))) {
+            continue;
+        }
+        prefetch_issue(&vm->prefetcher, page);
+    }
+}
+
+// Take a frame for a page: a never-used one, or the policy's victim after
+// evicting the page it holds; -1 if memory ran out (vm->failed is set)
+static int take_frame(Vmm *vm, int64_t page_number, long time) {
+    if (vm->free_frame < vm->frame_count) {
+        return vm->free_frame++;
+    }
+    int frame_number = vm->policy->victim(vm->policy, page_number, time);
+
+    // Invalidate the evicted page in the page table and TLBs
+    int64_t old_page = vm->frame_to_page[frame_number];
+    if (old_page != -1) {
+        // Save a dirty page before its frame is reused
+        if (*dirty_flag(vm, old_page, frame_number)) {
+            vm->dirty_evictions++;
+            if (vm->has_writeback) {
+                writeback_queue(&vm->writeback, old_page,
+                                &vm->physical_memory[(size_t)frame_number * vm->page_size]);
+            }
+        }
+        if (vm->inverted) {
+            invpt_unmap(&vm->inverted_table, frame_number);
+        } else {
+            page_table_find(&process_of(vm, old_page)->page_table, old_page)->valid = false;
+        }
+        process_of(vm, old_page)->resident--;
+        tlb_hierarchy_invalidate(&vm->tlbs, old_page);
+
+        // Evicting part of a huge page splits it
+        if (vm->has_huge) {
+            int split = hugepage_remove(&vm->huge, old_page);
+            if (split == -1) {
+                fprintf(stderr, "Error: Out of memory for huge page state\n");
+                vm->failed = true;
+                return -1;
+            }
+            if (split > 0) {
+                tlb_hierarchy_invalidate(&vm->tlbs, hugepage_key(&vm->huge, split, old_page));
+            }
+        }
+    }
+    return frame_number;
+}
+
+// Load a page into a frame, map it and start tracking it; returns the
+// frame and adds the fault service time (if the page had to be read from
+// the backing store) to *latency_ns. *promote (if not NULL) is set to the
+// huge page class the page's region now qualifies for. Returns -1 if
+// memory ran out (vm->failed is set).
+static int fault_in(Vmm *vm, VmmProcess *process, int64_t page_number, long time,
+                    double *latency_ns, int *promote) {
+    PageTableEntry *entry = NULL;
+    if (!vm->inverted && (entry = page_table_entry(&process->page_table, page_number)) == NULL) {
+        fprintf(stderr, "Error: Out of memory for page tables\n");
+        vm->failed = true;
+        return -1;
+    }
+
+    // Allocate a frame - either a free one or ask the policy for a victim
+    int frame_number = take_frame(vm, page_number, time);
+    if (frame_number == -1) {
+        return -1;
+    }
+
+    // Read page from the backing store directly into the frame (or from
+    // the write-back queue if its latest data has not been written yet,
+    // or from its staging frame if it was prefetched)
+    bool from_store = true;
+    if (vm->physical_memory != NULL) {
+        signed char *frame = &vm->physical_memory[(size_t)frame_number * vm->page_size];
+        if ((vm->has_writeback && writeback_lookup(&vm->writeback, page_number, frame)) ||
+            (vm->has_prefetch && prefetch_take(&vm->prefetcher, page_number, frame))) {
+            from_store = false;
+        } else {
+            backing_store_read_page(vm->store, page_number, frame);
+        }
+    }
+    if (from_store) {
+        double fault_ns = vm->cost.fault_us * 1000.0;
+        *latency_ns += fault_ns;
+        vm->latency.fault_ns += fault_ns;
+    }
+
+    // Update page table and start tracking the newly loaded frame
+    if (vm->inverted) {
+        invpt_map(&vm->inverted_table, page_number, frame_number);
+    } else {
+        entry->frame_number = frame_number;
+        entry->valid = true;
+        entry->dirty = false;
+    }
+    vm->frame_to_page[frame_number] = page_number;
+    process->resident++;
+    vm->policy->fill(vm->policy, frame_number, page_number, time);
+
+    if (vm->has_huge) {
+        int size = hugepage_add(&vm->huge, page_number);
+        if (size == -1) {
+            fprintf(stderr, "Error: Out of memory for huge page state\n");
+            vm->failed = true;
+            return -1;
+        }
+        if (promote != NULL) {
+            *promote = size;
+        }
+    }
+    return frame_number;
+}
+
+// Load the missing base pages of a page's region and map the region as a
+// huge page of class `size`; returns the page's frame afterwards, or -1 if
+// memory ran out (vm->failed is set)
+static int promote(Vmm *vm, VmmProcess *process, int size, int64_t page_number, long time,
+                   double *latency_ns) {
+    int64_t pages = (int64_t)1 << vm->huge.shifts[size];
+    int64_t first = page_number & ~(pages - 1);
+    PageTableEntry *entry;
+    for (int64_t page = first; page < first + pages; page++) {
+        if (resident_frame(vm, page, &entry) == -1) {
+            if (fault_in(vm, process, page, time, latency_ns, NULL) == -1) {
+                return -1;
+            }
+            vm->huge.promotion_loads++;
+        }
+    }
+
+    // Loading can evict pages of the region itself
+    if (!hugepage_full(&vm->huge, size, page_number)) {
+        vm->huge.failed_promotions++;
+    } else if (hugepage_promote(&vm->huge, size, page_number) != 0) {
+        fprintf(stderr, "Error: Out of memory for huge page state\n");
+        vm->failed = true;
+        return -1;
+    } else {
+        // Drop the smaller translations the huge page replaces
+        for (int64_t page = first; page < first + pages; page++) {
+            tlb_hierarchy_invalidate(&vm->tlbs, page);
+        }
+        for (int c = 1; c < size; c++) {
+            for (int64_t page = first; page < first + pages; page += (int64_t)1 << vm->huge.shifts[c]) {
+                tlb_hierarchy_invalidate(&vm->tlbs, hugepage_key(&vm->huge, c, page));
+            }
+        }
+    }
+
+    // Policies that ignore recency may have evicted the faulting page
+    int frame_number = resident_frame(vm, page_number, &entry);
+    if (frame_number == -1 && (frame_number = fault_in(vm, process, page_number, time, latency_ns, NULL)) != -1) {
+        vm->huge.promotion_loads++;
+    }
+    return frame_number;
+}
+
+// Look up a page's translation at every size class
+static inline int lookup_sizes(Vmm *vm, int64_t page_number) {
+    int64_t keys[MAX_HUGE_SIZES + 1];
+    for (int c = 0; c <= vm->huge.count; c++) {
+        keys[c] = hugepage_key(&vm->huge, c, page_number);
+    }
+    int size;
+    int frame_number = tlb_hierarchy_lookup_keys(&vm->tlbs, keys, vm->huge.count + 1, &size);
+    if (frame_number != -1 && size > 0) {
+        // Huge entries only say the region is mapped
+        PageTableEntry *entry;
+        vm->huge.tlb_hits++;
+        frame_number = resident_frame(vm, page_number, &entry);
+    }
+    return frame_number;
+}
+
+// Translate a decoded reference of a process that has been set up
+static inline uint64_t translate(Vmm *vm, VmmProcess *process, int64_t page_number, int offset,
+                                 bool write, signed char *value) {
+    long time = vm->references;  // Index of this reference in the trace
+    vm->references++;
+    process->references++;
+
+    // Check TLB for page number; every reference pays the L1 lookup and the
+    // memory access, and L1 misses also pay the L2 lookup
+    long l1_hits = vm->tlbs.l1_hits;
+    int frame_number = vm->has_huge ? lookup_sizes(vm, page_number)
+                                    : tlb_hierarchy_lookup(&vm->tlbs, page_number);
+    double latency_ns = vm->cost.l1_tlb_ns + vm->cost.memory_ns;
+    if (vm->tlbs.has_l2 && vm->tlbs.l1_hits == l1_hits) {
+        latency_ns += vm->cost.l2_tlb_ns;
+    }
+    PageTableEntry *entry = NULL;
+    if (frame_number != -1) {
+        vm->tlb_hits++;
+        // Tell the replacement policy the frame was used
+        vm->policy->access(vm->policy, frame_number, page_number, time);
+    } else if ((frame_number = resident_frame(vm, page_number, &entry)) != -1) {
+        // TLB miss, but the page is resident
+        latency_ns += vm->walk_levels * vm->cost.walk_ns;
+        vm->policy->access(vm->policy, frame_number, page_number, time);
+        tlb_hierarchy_fill(&vm->tlbs, vm->has_huge ? hugepage_key(&vm->huge, hugepage_class(&vm->huge, page_number),
+                                                                  page_number) : page_number,
+                           frame_number);
+    } else {
+        // Page fault - load from backing store
+        vm->page_faults++;
+        process->page_faults++;
+        latency_ns += vm->walk_levels * vm->cost.walk_ns;
+        int size = 0;
+        frame_number = fault_in(vm, process, page_number, time, &latency_ns, &size);
+        if (frame_number != -1 && size > 0) {
+            frame_number = promote(vm, process, size, page_number, time, &latency_ns);
+            size = hugepage_class(&vm->huge, page_number);
+        }
+        if (frame_number == -1) {
+            *value = 0;
+            return 0;
+        }
+        tlb_hierarchy_fill(&vm->tlbs, vm->has_huge ? hugepage_key(&vm->huge, size, page_number) : page_number,
+                           frame_number);
+        if (vm->has_prefetch) {
+            prefetch_after_fault(vm, page_number);
+        }
+    }
+    if (vm->has_huge && time % HUGE_REACH_SAMPLE == 0) {
+        double base_bytes;
+        vm->huge.reach_sum += hugepage_reach(&vm->huge, &vm->tlbs, vm->page_size, &base_bytes);
+        vm->huge.base_reach_sum += base_bytes;
+        vm->huge.reach_samples++;
+    }
+
+    // Calculate physical address and get byte value from physical memory
+    uint64_t physical_address = (uint64_t)frame_number * vm->page_size + offset;
+    if (write) {
+        vm->writes++;
+        *dirty_flag(vm, page_number, frame_number) = true;
+        if (vm->physical_memory != NULL) {
+            vm->physical_memory[physical_address]++;
+        }
+    }
+    *value = vm->physical_memory != NULL ? vm->physical_memory[physical_address] : 0;
+    latency_record(&vm->latency, latency_ns);
+    return physical_address;
+}
+
+uint64_t vmm_access_asid(Vmm *vm, uint16_t asid, uint64_t logical_address, bool write,
+                         signed char *value) {
+    if (asid >= vm->process_count && add_processes(vm, asid) != 0) {
+        *value = 0;
+        return 0;
+    }
+
+    // Extract page number (keyed by process) and offset from logical address
+    int64_t page_number = vmm_page_key(vm, asid, logical_address);
+    int offset = (int)(logical_address & (uint64_t)(vm->page_size - 1));
+    return translate(vm, &vm->processes[asid], page_number, offset, write, value);
+}
+
+int vmm_translate_batch(Vmm *vm, const uint32_t *vaddrs, size_t n, uint32_t *paddrs, int8_t *values) {
+    if (!vmm_batch_ok(vm)) {
+        fprintf(stderr, "Error: Physical addresses of %d %d-byte frames do not fit in 32 bits\n",
+                vm->frame_count, vm->page_size);
+        return -1;
+    }
+    int64_t pages[VMM_BATCH];
+    int offsets[VMM_BATCH];
+    uint32_t mask = (uint32_t)vm->address_mask;
+    uint32_t offset_mask = (uint32_t)vm->page_size - 1;
+    int page_bits = vm->page_bits;
+
+    for (size_t start = 0; start < n; start += VMM_BATCH) {
+        size_t len = n - start < VMM_BATCH ? n - start : VMM_BATCH;
+        const uint32_t *in = vaddrs + start;
+
+        // Decode stage: no dependencies between addresses, so it vectorizes
+        for (size_t i = 0; i < len; i++) {
+            pages[i] = (int64_t)((in[i] & mask) >> page_bits);
+            offsets[i] = (int)(in[i] & offset_mask);
+        }
+
+        // Translate stage, in trace order
+        for (size_t i = 0; i < len; i++) {
+            signed char value;
+            paddrs[start + i] = (uint32_t)translate(vm, &vm->processes[0], pages[i], offsets[i], false, &value);
+            values[start + i] = value;
+            if (vm->failed) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+void vmm_get_stats(const Vmm *vm, VmmStats *stats) {
+    stats->references = vm->references;
+    stats->page_faults = vm->page_faults;
+    stats->tlb_hits = vm->tlb_hits;
+    stats->l1_tlb_hits = vm->tlbs.l1_hits;
+    stats->l2_tlb_hits = vm->tlbs.l2_hits;
+    stats->page_walks = vm->tlbs.walks;
+    stats->writes = vm->writes;
+    stats->dirty_evictions = vm->dirty_evictions;
+    stats->processes = vm->process_count;
+    stats->simulated_ns = vm->latency.total_ns;
+    stats->fault_ns = vm->latency.fault_ns;
+    stats->walk_levels = vm->walk_levels;
+    if (vm->inverted) {
+        stats->page_tables = 0;
+        stats->page_table_bytes = vm->inverted_table.bytes;
+    } else {
+        stats->page_tables = vmm_page_tables(vm, &stats->page_table_bytes);
+    }
+    stats->huge_promotions = vm->huge.promotions;
+    stats->failed_promotions = vm->huge.failed_promotions;
+    stats->huge_demotions = vm->huge.demotions;
+    stats->promotion_loads = vm->huge.promotion_loads;
+    stats->huge_tlb_hits = vm->huge.tlb_hits;
+    stats->tlb_reach = vm->huge.reach_samples > 0 ? vm->huge.reach_sum / vm->huge.reach_samples : 0.0;
+    stats->tlb_base_reach = vm->huge.reach_samples > 0 ?
+                            vm->huge.base_reach_sum / vm->huge.reach_samples : 0.0;
+}
+
+void vmm_sync(Vmm *vm) {
+    if (!vm->has_writeback) {
+        return;
+    }
+    for (int frame = 0; frame < vm->free_frame; frame++) {
+        int64_t page = vm->frame_to_page[frame];
+        bool *dirty = dirty_flag(vm, page, frame);
+        if (*dirty) {
+            writeback_queue(&vm->writeback, page, &vm->physical_memory[(size_t)frame * vm->page_size]);
+            *dirty = false;
+        }
+    }
+    writeback_flush(&vm->writeback);
+}
+
+long vmm_page_tables(const Vmm *vm, size_t *bytes) {
+    long tables = 0;
+    *bytes = 0;
+    for (int i = 0; i < vm->process_count; i++) {
+        tables += vm->processes[i].page_table.tables;
+        *bytes += vm->processes[i].page_table.bytes;
+    }
+    return tables;
+}
+
+long *vmm_next_use(const VmmConfig *config, const uint64_t *addresses, const uint16_t *asids,
+                   long count) {
+    int page_bits = page_bits_of(config);
+    if (page_bits == -1) {
+        return NULL;
+    }
+    uint64_t mask = address_mask_of(config);
+    int64_t *pages = malloc((count > 0 ? count : 1) * sizeof(int64_t));
+    if (pages == NULL) {
+        return NULL;
+    }
+    for (long i = 0; i < count; i++) {
+        pages[i] = (int64_t)((addresses[i] & mask) >> page_bits);
+        if (asids != NULL) {
+            pages[i] |= (int64_t)asids[i] << (config->address_bits - page_bits);
+        }
+    }
+    long *next_use = policy_next_use(pages, count);
+    free(pages);
+    return next_use;
+}
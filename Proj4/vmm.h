@@ -0,0 +1,247 @@
+/**
+ * Project 4 - Virtual memory manager core
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * All of the Part 2 translation state (page table, TLBs, frames and the
+ * replacement policy) lives in a Vmm context, so several simulations can
+ * run side by side, e.g. one per worker thread in a parameter sweep.
+ *
+ * A Vmm created without a backing store only keeps statistics: no physical
+ * memory is allocated and every value reads as 0.
+ *
+ * The address width and page size are configurable. The defaults (16-bit
+ * addresses, 256-byte pages, at most 256 frames) are the original
+ * assignment; wider address spaces use a multi-level radix page table
+ * (see pagetable.h) and allow up to MAX_WIDE_FRAMES frames. For large
+ * sparse spaces an inverted page table (see invpt.h) sized by the frame
+ * count can be used instead.
+ *
+ * Writes mark pages dirty. The trace carries no data, so a write increments
+ * the addressed byte. Evicted dirty pages are written back through a
+ * batching queue (see writeback.h) when the backing store is writable;
+ * with a read-only store they are only counted.
+ *
+ * With a prefetcher (see prefetch.h) every page fault also predicts the
+ * next pages to fault and starts reading the ones that are neither resident
+ * nor waiting to be written back. Prefetched pages are staged outside the
+ * simulated frames, so page fault counts are unchanged; a fault whose page
+ * is staged just avoids the synchronous backing store read.
+ *
+ * Every reference is also charged a simulated latency under the
+ * configuration's cost model (see latency.h). Faults served from the
+ * write-back queue or a prefetch staging frame are not charged the fault
+ * service time.
+ *
+ * References may come from several processes, each tagged with an address
+ * space ID (ASID). Every process gets its own radix page table; TLB
+ * entries, the inverted table, the replacement policy and the write-back
+ * queue see page keys with the ASID above the page number bits, so
+ * switching processes needs no flush. All processes share one frame pool,
+ * replaced globally by the usual policies or per process by ws / pff (see
+ * replace.h). In the backing store each process has its own region of
+ * 2^(address bits - page bits) pages, process 0's being the original file.
+ *
+ * Hot regions can be promoted to huge pages of several sizes at once,
+ * sharing the TLBs with base pages (see hugepage.h).
+ *
+ * Both command line programs are thin wrappers over this library: they
+ * hand it whole trace blocks through vmm_translate_batch (read-only
+ * references of process 0 with 32-bit addresses) and read the results back
+ * through vmm_get_stats.
+ */
+#ifndef VMM_H
+#define VMM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "backing_store.h"
+#include "tlb.h"
+#include "replace.h"
+#include "pagetable.h"
+#include "invpt.h"
+#include "writeback.h"
+#include "prefetch.h"
+#include "latency.h"
+#include "hugepage.h"
+
+// Constants
+#define PAGE_SIZE 256          // Size of each page/frame (in bytes)
+#define PAGE_TABLE_SIZE 256    // Number of entries in page table (pages)
+#define MAX_FRAMES 256         // Maximum possible frames
+#define ADDRESS_MASK 0xFFFF    // Mask for extracting 16 least significant bits
+#define ADDRESS_BITS 16        // Default logical address width
+#define MAX_WIDE_FRAMES (1 << 24) // Frame limit for wider address spaces
+#define PAGE_TABLE_NAMES "radix|inverted"
+#define WRITEBACK_BATCH 32     // Default pages per write-back batch
+#define MAX_ASID_PAGE_BITS 47  // Widest page numbers usable with ASIDs above 0
+#define VMM_BATCH 256          // Addresses decoded per batch translation stage
+
+// Simulation parameters
+typedef struct {
+    int frame_count;             // Number of frames in physical memory
+    int address_bits;            // Logical address width (16-64)
+    int page_size;               // Bytes per page (power of two)
+    const char *page_table;      // Page table organization name
+    int page_table_levels;       // Radix page table levels (0 = automatic)
+    const char *policy;          // Page replacement policy name
+    const long *next_use;        // Next-use indices (required by "opt")
+    long ws_window;              // Working-set window (ws policy)
+    long pff_interval;           // Fault interval threshold (pff policy)
+    int tlb_size;                // L1 TLB entries
+    int tlb_ways;                // L1 TLB associativity (0 = fully associative)
+    const char *tlb_policy;      // L1 TLB replacement policy name
+    int l2_tlb_size;             // L2 TLB entries (0 = no L2)
+    int l2_tlb_ways;
+    const char *l2_tlb_policy;
+    const char *tlb_inclusion;   // L2 inclusion policy name
+    int writeback_batch;         // Pages per write-back batch
+    bool async_writeback;        // Write batches on a background thread
+    const char *prefetch;        // Prefetch predictor name
+    int prefetch_degree;         // Pages predicted per fault
+    int prefetch_frames;         // Staging frames for prefetched pages
+    CostModel cost;              // Simulated latencies
+    const int *huge_pages;       // Huge page sizes in base pages (NULL = none)
+    int huge_page_count;
+    int promote_percent;         // Share of a region resident before promotion
+} VmmConfig;
+
+// Per-process state
+typedef struct {
+    PageTable page_table;         // Radix page table (unused when inverted)
+    long references;
+    long page_faults;
+    int resident;                 // Frames holding the process's pages
+} VmmProcess;
+
+// Simulator state
+typedef struct {
+    int frame_count;
+    int page_size;
+    int page_bits;                // log2(page_size)
+    int vpn_bits;                 // Page number bits; the ASID sits above them
+    uint64_t address_mask;        // Low address_bits bits set
+    bool inverted;                // Inverted page table instead of radix
+    VmmProcess *processes;        // Indexed by ASID
+    int process_count;            // ASIDs below this have been set up
+    int process_capacity;
+    InvertedPageTable inverted_table;
+    signed char *physical_memory; // NULL in statistics-only mode
+    int64_t *frame_to_page;       // Reverse map: page currently held by each frame
+    int free_frame;               // Next never-used frame
+    ReplacementPolicy *policy;
+    TlbHierarchy tlbs;
+    BackingStore *store;          // Shared backing store (may be NULL)
+    bool has_writeback;           // Store is writable: dirty pages go to `writeback`
+    WriteBack writeback;
+    bool has_prefetch;            // Faults predict and prefetch through `prefetcher`
+    Prefetcher prefetcher;
+    CostModel cost;
+    int walk_levels;              // Memory accesses per page table walk
+    LatencyStats latency;         // Simulated time per reference
+    bool has_huge;                // Hot regions are promoted through `huge`
+    HugePages huge;
+    long references;              // Addresses translated
+    long page_faults;
+    long tlb_hits;                // Hits in any TLB level
+    long writes;                  // References that were writes
+    long dirty_evictions;         // Evicted pages that were dirty
+    bool failed;                  // Ran out of memory mid-simulation
+} Vmm;
+
+// Counters of a simulation so far
+typedef struct {
+    long references;             // Addresses translated
+    long page_faults;
+    long tlb_hits;               // Hits in any TLB level
+    long l1_tlb_hits;
+    long l2_tlb_hits;
+    long page_walks;             // References that missed every TLB
+    long writes;
+    long dirty_evictions;
+    int processes;               // ASIDs seen (0 up to the highest)
+    double simulated_ns;         // Total simulated time
+    double fault_ns;             // Part of it spent reading the backing store
+    int walk_levels;             // Memory accesses per page table walk
+    long page_tables;            // Radix tables allocated (0 when inverted)
+    size_t page_table_bytes;     // Memory used by the page tables
+    long huge_promotions;        // Regions mapped as huge pages
+    long failed_promotions;
+    long huge_demotions;         // Huge pages split by evictions
+    long promotion_loads;        // Base pages loaded to fill regions
+    long huge_tlb_hits;          // TLB hits on huge page entries
+    double tlb_reach;            // Mean bytes mapped by the TLBs (with huge pages)
+    double tlb_base_reach;       // Same, had every entry mapped one base page
+} VmmStats;
+
+// Fill in the defaults (16-bit addresses, 256-byte pages, 128 frames, LRU,
+// 16-entry FIFO TLB, no L2)
+void vmm_config_init(VmmConfig *config);
+
+// Largest frame count allowed for a configuration's address space
+int vmm_max_frames(const VmmConfig *config);
+
+// Page number of a logical address (after masking to the address width)
+static inline int64_t vmm_page_number(const Vmm *vm, uint64_t logical_address) {
+    return (int64_t)((logical_address & vm->address_mask) >> vm->page_bits);
+}
+
+// Page key of a process's logical address: the ASID above the page number
+static inline int64_t vmm_page_key(const Vmm *vm, uint16_t asid, uint64_t logical_address) {
+    return ((int64_t)asid << vm->vpn_bits) | vmm_page_number(vm, logical_address);
+}
+
+// Create a simulator; reports bad parameters on stderr and returns NULL
+Vmm *vmm_create(const VmmConfig *config, BackingStore *store);
+
+// Free a simulator (the backing store is not closed)
+void vmm_destroy(Vmm *vm);
+
+// Translate one logical address (masked to the address width) of a process
+// for a read or a write; returns the physical address and stores the byte
+// found there (after the write, for writes) in *value. ASIDs above 0 need
+// vmm_asids_ok. If memory runs out (or an ASID does not fit) it reports it
+// on stderr, sets vm->failed and returns 0; the simulator can then only be
+// destroyed.
+uint64_t vmm_access_asid(Vmm *vm, uint16_t asid, uint64_t logical_address, bool write,
+                         signed char *value);
+
+// Translate a logical address of process 0
+static inline uint64_t vmm_access(Vmm *vm, uint64_t logical_address, bool write, signed char *value) {
+    return vmm_access_asid(vm, 0, logical_address, write, value);
+}
+
+// Translate n read-only addresses of process 0 in order, the same as n
+// vmm_access calls: physical addresses go to paddrs and bytes to values.
+// Fails (-1, reported on stderr) if physical addresses do not fit in 32 bits
+// or memory runs out (which sets vm->failed, as for vmm_access_asid).
+int vmm_translate_batch(Vmm *vm, const uint32_t *vaddrs, size_t n, uint32_t *paddrs, int8_t *values);
+
+// Whether a simulator's physical addresses fit vmm_translate_batch
+static inline bool vmm_batch_ok(const Vmm *vm) {
+    return (uint64_t)vm->frame_count * vm->page_size <= (uint64_t)UINT32_MAX + 1;
+}
+
+// Whether a simulator's page numbers leave room for ASIDs above 0
+static inline bool vmm_asids_ok(const Vmm *vm) {
+    return vm->vpn_bits <= MAX_ASID_PAGE_BITS;
+}
+
+// Snapshot the counters
+void vmm_get_stats(const Vmm *vm, VmmStats *stats);
+
+// Radix page tables allocated over all processes (and their size in bytes)
+long vmm_page_tables(const Vmm *vm, size_t *bytes);
+
+// Write back every dirty resident page and wait for queued write-backs
+void vmm_sync(Vmm *vm);
+
+// Compute next-use indices of a trace for the OPT policy, decoding pages
+// with the configuration's geometry (asids may be NULL for a single
+// process); NULL on failure
+long *vmm_next_use(const VmmConfig *config, const uint64_t *addresses, const uint16_t *asids,
+                   long count);
+
+#endif
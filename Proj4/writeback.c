@@ -0,0 +1,218 @@
+/**
+ * Project 4 - Dirty page write-back
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "writeback.h"
+
+static int alloc_batch(WriteBatch *batch, int batch_pages, int page_size) {
+    batch->pages = malloc(batch_pages * sizeof(int64_t));
+    batch->data = malloc((size_t)batch_pages * page_size);
+    batch->count = 0;
+    return batch->pages == NULL || batch->data == NULL ? -1 : 0;
+}
+
+static void free_batch(WriteBatch *batch) {
+    free(batch->pages);
+    free(batch->data);
+    batch->pages = NULL;
+    batch->data = NULL;
+}
+
+// Slot of a page in a batch, or -1
+static int find_slot(const WriteBatch *batch, int64_t page_number) {
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->pages[i] == page_number) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int compare_order(const void *a, const void *b) {
+    int64_t pa = ((const WriteOrder *)a)->page;
+    int64_t pb = ((const WriteOrder *)b)->page;
+    return (pa > pb) - (pa < pb);
+}
+
+// Write a batch in page order, one call per run of consecutive pages.
+// Runs on the writer thread in async mode.
+static void write_batch(WriteBack *wb, const WriteBatch *batch) {
+    WriteOrder *order = wb->order;
+    for (int i = 0; i < batch->count; i++) {
+        order[i].page = batch->pages[i];
+        order[i].slot = i;
+    }
+    qsort(order, batch->count, sizeof(WriteOrder), compare_order);
+
+    long calls = 0;
+    bool failed = false;
+    for (int i = 0; i < batch->count; ) {
+        int length = 0;
+        int64_t first = order[i].page;
+        while (i + length < batch->count && order[i + length].page == first + length) {
+            wb->run[length] = batch->data + (size_t)order[i + length].slot * wb->page_size;
+            length++;
+        }
+        if (backing_store_write_pages(wb->store, first, wb->run, length) != 0) {
+            failed = true;
+        }
+        calls++;
+        i += length;
+    }
+
+    pthread_mutex_lock(&wb->lock);
+    wb->pages_written += batch->count;
+    wb->bytes_written += (long)batch->count * wb->page_size;
+    wb->write_calls += calls;
+    wb->error = wb->error || failed;
+    pthread_mutex_unlock(&wb->lock);
+}
+
+static void *writer_thread(void *arg) {
+    WriteBack *wb = arg;
+    pthread_mutex_lock(&wb->lock);
+    while (1) {
+        while (!wb->busy && !wb->stop) {
+            pthread_cond_wait(&wb->cond, &wb->lock);
+        }
+        if (!wb->busy) {
+            break;
+        }
+        // The simulator leaves `flight` alone while busy
+        pthread_mutex_unlock(&wb->lock);
+        write_batch(wb, &wb->flight);
+        pthread_mutex_lock(&wb->lock);
+        wb->busy = false;
+        pthread_cond_broadcast(&wb->cond);
+    }
+    pthread_mutex_unlock(&wb->lock);
+    return NULL;
+}
+
+int writeback_init(WriteBack *wb, BackingStore *store, int page_size, int batch_pages, bool async) {
+    memset(wb, 0, sizeof(*wb));
+    wb->store = store;
+    wb->page_size = page_size;
+    wb->batch_pages = batch_pages;
+    wb->async = async;
+    pthread_mutex_init(&wb->lock, NULL);
+    pthread_cond_init(&wb->cond, NULL);
+
+    if (batch_pages <= 0) {
+        writeback_destroy(wb);
+        return -1;
+    }
+    wb->order = malloc(batch_pages * sizeof(WriteOrder));
+    wb->run = malloc(batch_pages * sizeof(signed char *));
+    if (wb->order == NULL || wb->run == NULL || alloc_batch(&wb->filling, batch_pages, page_size) != 0 ||
+        (async && alloc_batch(&wb->flight, batch_pages, page_size) != 0)) {
+        writeback_destroy(wb);
+        return -1;
+    }
+    if (async) {
+        if (pthread_create(&wb->thread, NULL, writer_thread, wb) != 0) {
+            writeback_destroy(wb);
+            return -1;
+        }
+        wb->started = true;
+    }
+    return 0;
+}
+
+// Hand the filling batch to the writer (async) or write it now
+static void submit(WriteBack *wb) {
+    if (wb->filling.count == 0) {
+        return;
+    }
+    if (!wb->async) {
+        write_batch(wb, &wb->filling);
+        wb->filling.count = 0;
+        return;
+    }
+
+    pthread_mutex_lock(&wb->lock);
+    if (wb->busy) {
+        wb->stalls++;
+        while (wb->busy) {
+            pthread_cond_wait(&wb->cond, &wb->lock);
+        }
+    }
+    WriteBatch done = wb->flight;
+    wb->flight = wb->filling;
+    wb->filling = done;
+    wb->filling.count = 0;
+    wb->busy = true;
+    pthread_cond_broadcast(&wb->cond);
+    pthread_mutex_unlock(&wb->lock);
+}
+
+void writeback_queue(WriteBack *wb, int64_t page_number, const signed char *data) {
+    wb->queued++;
+    int slot = find_slot(&wb->filling, page_number);
+    if (slot != -1) {
+        wb->coalesced++;
+    } else {
+        if (wb->filling.count == wb->batch_pages) {
+            submit(wb);
+        }
+        slot = wb->filling.count++;
+        wb->filling.pages[slot] = page_number;
+    }
+    memcpy(wb->filling.data + (size_t)slot * wb->page_size, data, wb->page_size);
+}
+
+bool writeback_lookup(const WriteBack *wb, int64_t page_number, signed char *dest) {
+    // The filling batch is newer than the one in flight
+    int slot = find_slot(&wb->filling, page_number);
+    const WriteBatch *batch = &wb->filling;
+    if (slot == -1 && wb->async) {
+        // Only this thread replaces `flight`, and the writer only reads it
+        slot = find_slot(&wb->flight, page_number);
+        batch = &wb->flight;
+    }
+    if (slot == -1) {
+        return false;
+    }
+    if (dest != NULL) {
+        memcpy(dest, batch->data + (size_t)slot * wb->page_size, wb->page_size);
+    }
+    return true;
+}
+
+void writeback_flush(WriteBack *wb) {
+    submit(wb);
+    if (wb->async) {
+        pthread_mutex_lock(&wb->lock);
+        while (wb->busy) {
+            pthread_cond_wait(&wb->cond, &wb->lock);
+        }
+        pthread_mutex_unlock(&wb->lock);
+    }
+}
+
+void writeback_destroy(WriteBack *wb) {
+    if (wb->filling.pages != NULL) {
+        writeback_flush(wb);
+    }
+    if (wb->started) {
+        pthread_mutex_lock(&wb->lock);
+        wb->stop = true;
+        pthread_cond_broadcast(&wb->cond);
+        pthread_mutex_unlock(&wb->lock);
+        pthread_join(wb->thread, NULL);
+        wb->started = false;
+    }
+    free_batch(&wb->filling);
+    free_batch(&wb->flight);
+    free(wb->order);
+    free(wb->run);
+    wb->order = NULL;
+    wb->run = NULL;
+    pthread_mutex_destroy(&wb->lock);
+    pthread_cond_destroy(&wb->cond);
+}
@@ -0,0 +1,80 @@
+/**
+ * Project 4 - Dirty page write-back
+ *
+ * Name: Jay Roy
+ * CWID: 12342760
+ *
+ * Evicted dirty pages are copied into a batch instead of being written one
+ * at a time. A page queued again before its batch is written replaces the
+ * earlier copy (coalescing), and when the batch is written its pages are
+ * sorted so runs of consecutive pages go out in a single vectored write.
+ *
+ * With an async writer, a full batch is handed to a background thread
+ * (double buffering) and the simulator keeps going; it only waits if the
+ * previous batch is still being written. Either way, a page that faults
+ * back in while its data is still queued is read from the queue, never
+ * from the (stale) store.
+ */
+#ifndef WRITEBACK_H
+#define WRITEBACK_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "backing_store.h"
+
+// Page and batch slot, for writing a batch in page order
+typedef struct {
+    int64_t page;
+    int slot;
+} WriteOrder;
+
+// One batch of queued pages
+typedef struct {
+    int64_t *pages;        // Page number per slot
+    signed char *data;     // page_size bytes per slot
+    int count;
+} WriteBatch;
+
+// Write-back queue state
+typedef struct {
+    BackingStore *store;
+    int page_size;
+    int batch_pages;       // Pages per batch
+    bool async;            // Batches are written by a background thread
+    WriteBatch filling;    // Batch being filled by the simulator
+    WriteBatch flight;     // Batch last handed to the writer thread
+    WriteOrder *order;     // Sort buffer (used by whichever thread writes)
+    const signed char **run; // Pages of one run of consecutive pages
+    bool busy;             // The writer thread is writing `flight`
+    bool stop;
+    bool started;          // The writer thread is running
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    long queued;           // Dirty pages queued
+    long coalesced;        // Queued pages replaced before being written
+    long pages_written;
+    long write_calls;      // Backing store writes (each a run of pages)
+    long bytes_written;
+    long stalls;           // Times the simulator waited for the writer
+    bool error;            // A write failed
+} WriteBack;
+
+// Set up a queue writing to a writable store; returns 0 on success
+int writeback_init(WriteBack *wb, BackingStore *store, int page_size, int batch_pages, bool async);
+
+// Queue a copy of a dirty page's data
+void writeback_queue(WriteBack *wb, int64_t page_number, const signed char *data);
+
+// If a page is still queued, copy its latest data into dest (unless NULL)
+// and return true
+bool writeback_lookup(const WriteBack *wb, int64_t page_number, signed char *dest);
+
+// Write every queued page and wait until the writes are done
+void writeback_flush(WriteBack *wb);
+
+// Flush, stop the writer thread and release the queue
+void writeback_destroy(WriteBack *wb);
+
+#endif